@@ -5,8 +5,8 @@
 void* _darray_create(u64 length, u64 stride) {
     u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
     u64 array_size = length * stride;
-    u64* new_array = tallocate(header_size + array_size, MEMORY_TAG_DARRAY);
-    tset_memory(new_array, 0, header_size + array_size);
+    // Elements past the length are never read, so only the header is written.
+    u64* new_array = tallocate_uninitialized(header_size + array_size, MEMORY_TAG_DARRAY);
     new_array[DARRAY_CAPACITY] = length;
     new_array[DARRAY_LENGTH] = 0;
     new_array[DARRAY_STRIDE] = stride;
@@ -30,24 +30,72 @@ void _darray_field_set(void* array, u64 field, u64 value) {
     header[field] = value;
 }
 
+// On failure returns FALSE and leaves *array as it was.
+static b8 darray_set_capacity(void** array, u64 capacity) {
+    u64* header = (u64*)*array - DARRAY_FIELD_LENGTH;
+    u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+    u64 old_size = header_size + header[DARRAY_CAPACITY] * header[DARRAY_STRIDE];
+    u64 new_size = header_size + capacity * header[DARRAY_STRIDE];
+
+    u64* new_header = treallocate(header, old_size, new_size, MEMORY_TAG_DARRAY);
+    if(!new_header) {
+        return FALSE;
+    }
+    new_header[DARRAY_CAPACITY] = capacity;
+    *array = (void*)(new_header + DARRAY_FIELD_LENGTH);
+    return TRUE;
+}
+
 void* _darray_resize(void* array) {
+    u64 capacity = DARRAY_RESIZE_FACTOR * darray_capacity(array);
+    if(capacity < DARRAY_MIN_CAPACITY) {
+        capacity = DARRAY_MIN_CAPACITY;
+    }
+    darray_set_capacity(&array, capacity);
+    return array;
+}
+
+void* _darray_reserve(void* array, u64 capacity) {
+    if(capacity > darray_capacity(array)) {
+        darray_set_capacity(&array, capacity);
+    }
+    return array;
+}
+
+void* _darray_shrink_to_fit(void* array) {
     u64 length = darray_length(array);
-    u64 stride = darray_stride(array);
-    void* temp = _darray_create(
-        (DARRAY_RESIZE_FACTOR * darray_capacity(array)),
-        stride);
-    tcopy_memory(temp, array, length * stride);
+    if(length != darray_capacity(array)) {
+        darray_set_capacity(&array, length);
+    }
+    return array;
+}
 
-    _darray_field_set(temp, DARRAY_LENGTH, length);
-    _darray_destroy(array);
-    return temp;
+// Makes room for at least required elements with a single reallocation.
+static b8 darray_grow_for(void** array, u64 required) {
+    u64 capacity = darray_capacity(*array);
+    if(required <= capacity) {
+        return TRUE;
+    }
+
+    capacity *= DARRAY_RESIZE_FACTOR;
+    if(capacity < required) {
+        capacity = required;
+    }
+    if(capacity < DARRAY_MIN_CAPACITY) {
+        capacity = DARRAY_MIN_CAPACITY;
+    }
+    if(!darray_set_capacity(array, capacity)) {
+        TERROR("Unable to grow array to %llu elements, nothing was added.", capacity);
+        return FALSE;
+    }
+    return TRUE;
 }
 
 void* _darray_push(void* array, const void* value_ptr) {
     u64 length = darray_length(array);
     u64 stride = darray_stride(array);
-    if(length >= darray_capacity(array)) {
-        array = _darray_resize(array);
+    if(!darray_grow_for(&array, length + 1)) {
+        return array;
     }
 
     u64 addr = (u64)array;
@@ -68,48 +116,97 @@ void _darray_pop(void* array, void* dest) {
 
 void* _darray_pop_at(void* array, u64 index, void* dest) {
     u64 length = darray_length(array);
-    u64 stride = darray_stride(array);
     if(index >= length) {
-        TERROR("Index outside the bounds of this array! Length: %i, index: %i", length, index);
+        TERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
         return array;
     }
 
-    u64 addr = (u64)array;
-    tcopy_memory(dest, (void*)(addr + (index * stride)), stride);
+    _darray_remove_range(array, index, 1, dest);
+    return array;
+}
 
-    if(index != length - 1) {
-        tcopy_memory(
-            (void*)(addr + (index * stride)),
-            (void*)(addr + ((index + 1) * stride)),
-            stride * (length - index));
+void* _darray_insert_at(void* array, u64 index, void* value_ptr) {
+    return _darray_insert_range(array, index, value_ptr, 1);
+}
+
+void* _darray_push_range(void* array, const void* values, u64 count) {
+    if(count == 0) {
+        return array;
     }
 
-    _darray_field_set(array, DARRAY_LENGTH, length - 1);
+    u64 length = darray_length(array);
+    u64 stride = darray_stride(array);
+    if(!darray_grow_for(&array, length + count)) {
+        return array;
+    }
+
+    tcopy_memory((u8*)array + length * stride, values, count * stride);
+    _darray_field_set(array, DARRAY_LENGTH, length + count);
     return array;
 }
 
-void* _darray_insert_at(void* array, u64 index, void* value_ptr) {
+void* _darray_insert_range(void* array, u64 index, const void* values, u64 count) {
     u64 length = darray_length(array);
+    if(index > length) {
+        TERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
+        return array;
+    }
+    if(count == 0) {
+        return array;
+    }
+
     u64 stride = darray_stride(array);
-    if(index >= length) {
-        TERROR("Index outside the bounds of this array! Length: %i, index: %i", length, index);
+    if(!darray_grow_for(&array, length + count)) {
         return array;
     }
-    if(length >= darray_capacity(array)) {
-        array = _darray_resize(array);
+
+    u8* base = (u8*)array;
+    if(index < length) {
+        tmove_memory(base + (index + count) * stride, base + index * stride, (length - index) * stride);
     }
+    tcopy_memory(base + index * stride, values, count * stride);
 
-    u64 addr = (u64)array;
+    _darray_field_set(array, DARRAY_LENGTH, length + count);
+    return array;
+}
 
-    if(index != length - 1) {
-        tcopy_memory(
-            (void*)(addr + ((index + 1) * stride)),
-            (void*)(addr + (index * stride)),
-            stride * (length - index));
+void _darray_remove_range(void* array, u64 index, u64 count, void* dest) {
+    u64 length = darray_length(array);
+    if(index > length || count > length - index) {
+        TERROR("Range outside the bounds of this array! Length: %llu, index: %llu, count: %llu", length, index, count);
+        return;
+    }
+    if(count == 0) {
+        return;
     }
 
-    tcopy_memory((void*)(addr + (index * stride)), value_ptr, stride);
+    u64 stride = darray_stride(array);
+    u8* base = (u8*)array;
+    if(dest) {
+        tcopy_memory(dest, base + index * stride, count * stride);
+    }
 
-    _darray_field_set(array, DARRAY_LENGTH, length + 1);
-    return array;
+    u64 tail = length - index - count;
+    if(tail > 0) {
+        tmove_memory(base + index * stride, base + (index + count) * stride, tail * stride);
+    }
+    _darray_field_set(array, DARRAY_LENGTH, length - count);
+}
+
+void _darray_swap_remove(void* array, u64 index, void* dest) {
+    u64 length = darray_length(array);
+    if(index >= length) {
+        TERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
+        return;
+    }
+
+    u64 stride = darray_stride(array);
+    u8* base = (u8*)array;
+    if(dest) {
+        tcopy_memory(dest, base + index * stride, stride);
+    }
+    if(index != length - 1) {
+        tcopy_memory(base + index * stride, base + (length - 1) * stride, stride);
+    }
+    _darray_field_set(array, DARRAY_LENGTH, length - 1);
 }
\ No newline at end of file
@@ -16,6 +16,8 @@ TAPI u64 _darray_field_get(void* array, u64 field);
 TAPI void _darray_field_set(void* array, u64 field, u64 value);
 
 TAPI void* _darray_resize(void* array);
+TAPI void* _darray_reserve(void* array, u64 capacity);
+TAPI void* _darray_shrink_to_fit(void* array);
 
 TAPI void* _darray_push(void* array, const void* value_ptr);
 TAPI void _darray_pop(void* array, void* dest);
@@ -23,7 +25,13 @@ TAPI void _darray_pop(void* array, void* dest);
 TAPI void* _darray_pop_at(void* array, u64 index, void* dest);
 TAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
 
-#define DARRAY_DEFAULT_CAPACITY 1
+TAPI void* _darray_push_range(void* array, const void* values, u64 count);
+TAPI void* _darray_insert_range(void* array, u64 index, const void* values, u64 count);
+TAPI void _darray_remove_range(void* array, u64 index, u64 count, void* dest);
+TAPI void _darray_swap_remove(void* array, u64 index, void* dest);
+
+#define DARRAY_DEFAULT_CAPACITY 8
+#define DARRAY_MIN_CAPACITY 8
 #define DARRAY_RESIZE_FACTOR 2
 
 #define darray_create(type) \
@@ -34,6 +42,15 @@ TAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
 
 #define darray_destroy(array) _darray_destroy(array);
 
+// Grows the existing array to hold at least capacity elements. May move it.
+// If memory runs out the array is left as it was, so check the capacity.
+#define darray_reserve_in_place(array, capacity) \
+    array = _darray_reserve(array, capacity)
+
+// Releases capacity beyond the current length. May move the array.
+#define darray_shrink_to_fit(array) \
+    array = _darray_shrink_to_fit(array)
+
 #define darray_push(array, value)                \
     {                                            \
         typeof(value) temp = value;              \
@@ -52,6 +69,23 @@ TAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
 #define darray_pop_at(array, index, value_ptr) \
     _darray_pop_at(array, index, value_ptr)
 
+// Appends count elements from values with at most one reallocation.
+#define darray_push_range(array, values, count) \
+    array = _darray_push_range(array, values, count)
+
+// Inserts count elements before index (index == length appends).
+#define darray_insert_range(array, index, values, count) \
+    array = _darray_insert_range(array, index, values, count)
+
+// Removes count elements starting at index, copying them to dest if it
+// is not 0, and closes the gap with a single move.
+#define darray_remove_range(array, index, count, dest) \
+    _darray_remove_range(array, index, count, dest)
+
+// O(1) removal that moves the last element into index. Does not keep order.
+#define darray_swap_remove(array, index, value_ptr) \
+    _darray_swap_remove(array, index, value_ptr)
+
 #define darray_clear(array) \
     _darray_field_set(array, DARRAY_LENGTH, 0)
 
@@ -0,0 +1,265 @@
+#include "containers/hashtable.h"
+
+#include "core/tmemory.h"
+#include "core/tstring.h"
+#include "core/logger.h"
+
+#define HASHTABLE_MIN_CAPACITY 16
+// Marks a slot as occupied so a stored hash is never 0.
+#define HASHTABLE_OCCUPIED_BIT 0x8000000000000000ull
+
+typedef struct hashtable_slot {
+    u64 hash;
+    u64 key;
+} hashtable_slot;
+
+static u64 hash_string(const char* key) {
+    // FNV-1a
+    u64 hash = 0xcbf29ce484222325ull;
+    for(const u8* c = (const u8*)key; *c; ++c) {
+        hash ^= *c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static u64 hash_pointer(u64 key) {
+    // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
+
+static u64 hash_key(hashtable* table, const void* key) {
+    u64 hash = table->key_type == HASHTABLE_KEY_STRING ? hash_string(key) : hash_pointer((u64)key);
+    return hash | HASHTABLE_OCCUPIED_BIT;
+}
+
+static b8 keys_equal(hashtable* table, const hashtable_slot* slot, u64 hash, const void* key) {
+    if(slot->hash != hash) {
+        return FALSE;
+    }
+    if(table->key_type == HASHTABLE_KEY_STRING) {
+        return strings_equal((const char*)slot->key, key);
+    }
+    return slot->key == (u64)key;
+}
+
+// The occupied bit in the stored hash marks used slots, so a pointer key
+// of 0 is fine. Only string tables need a key to point at.
+static b8 key_valid(hashtable* table, const void* key) {
+    return key || table->key_type == HASHTABLE_KEY_POINTER;
+}
+
+static void* value_at(hashtable* table, u64 index) {
+    return (u8*)table->values + index * table->stride;
+}
+
+// Returns the slot holding key, or the empty slot where it would go.
+static u64 find_slot(hashtable* table, u64 hash, const void* key) {
+    u64 mask = table->capacity - 1;
+    u64 index = hash & mask;
+    while(table->slots[index].hash && !keys_equal(table, &table->slots[index], hash, key)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+static void free_storage(hashtable* table) {
+    if(table->slots) {
+        tfree(table->slots, sizeof(hashtable_slot) * table->capacity, MEMORY_TAG_DICT);
+    }
+    if(table->values) {
+        tfree(table->values, table->stride * table->capacity, MEMORY_TAG_DICT);
+    }
+    table->slots = 0;
+    table->values = 0;
+}
+
+// Either both blocks are allocated or neither is.
+static b8 allocate_storage(hashtable* table, u64 capacity) {
+    table->slots = tallocate(sizeof(hashtable_slot) * capacity, MEMORY_TAG_DICT);
+    table->values = 0;
+    if(table->stride > 0) {
+        table->values = tallocate_uninitialized(table->stride * capacity, MEMORY_TAG_DICT);
+    }
+    table->capacity = capacity;
+    if(!table->slots || (table->stride > 0 && !table->values)) {
+        free_storage(table);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static b8 rehash(hashtable* table, u64 capacity) {
+    hashtable old = *table;
+    if(!allocate_storage(table, capacity)) {
+        *table = old;
+        return FALSE;
+    }
+
+    // Keys move as-is; string copies stay owned by the table.
+    for(u64 i = 0; i < old.capacity; ++i) {
+        hashtable_slot* slot = &old.slots[i];
+        if(slot->hash) {
+            u64 mask = table->capacity - 1;
+            u64 index = slot->hash & mask;
+            while(table->slots[index].hash) {
+                index = (index + 1) & mask;
+            }
+            table->slots[index] = *slot;
+            if(table->stride > 0) {
+                tcopy_memory(value_at(table, index), (u8*)old.values + i * old.stride, table->stride);
+            }
+        }
+    }
+
+    free_storage(&old);
+    return TRUE;
+}
+
+static void free_key(hashtable* table, hashtable_slot* slot) {
+    if(table->key_type == HASHTABLE_KEY_STRING) {
+        char* key = (char*)slot->key;
+        tfree(key, string_length(key) + 1, MEMORY_TAG_DICT);
+    }
+}
+
+b8 hashtable_create(u64 stride, u64 initial_capacity, hashtable_key_type key_type, hashtable* out_table) {
+    if(!out_table) {
+        TERROR("hashtable_create requires a valid pointer to hold the table.");
+        return FALSE;
+    }
+
+    // Size for initial_capacity entries below the load factor limit.
+    u64 capacity = HASHTABLE_MIN_CAPACITY;
+    while(capacity * 3 < initial_capacity * 4) {
+        capacity *= 2;
+    }
+
+    out_table->stride = stride;
+    out_table->count = 0;
+    out_table->key_type = key_type;
+    return allocate_storage(out_table, capacity);
+}
+
+void hashtable_destroy(hashtable* table) {
+    if(!table) {
+        return;
+    }
+
+    hashtable_clear(table);
+    free_storage(table);
+    table->capacity = 0;
+}
+
+b8 hashtable_set(hashtable* table, const void* key, const void* value) {
+    if(!table || !table->slots || !key_valid(table, key)) {
+        return FALSE;
+    }
+
+    u64 hash = hash_key(table, key);
+    u64 index = find_slot(table, hash, key);
+    hashtable_slot* slot = &table->slots[index];
+    if(!slot->hash) {
+        // Only a new key counts towards the load factor.
+        if((table->count + 1) * 4 > table->capacity * 3) {
+            if(!rehash(table, table->capacity * 2)) {
+                return FALSE;
+            }
+            index = find_slot(table, hash, key);
+            slot = &table->slots[index];
+        }
+
+        if(table->key_type == HASHTABLE_KEY_STRING) {
+            u64 length = string_length(key);
+            char* copy = tallocate_uninitialized(length + 1, MEMORY_TAG_DICT);
+            if(!copy) {
+                return FALSE;
+            }
+            tcopy_memory(copy, key, length + 1);
+            slot->key = (u64)copy;
+        } else {
+            slot->key = (u64)key;
+        }
+        slot->hash = hash;
+        table->count++;
+    }
+
+    if(table->stride > 0) {
+        if(value) {
+            tcopy_memory(value_at(table, index), value, table->stride);
+        } else {
+            tzero_memory(value_at(table, index), table->stride);
+        }
+    }
+    return TRUE;
+}
+
+void* hashtable_get(hashtable* table, const void* key) {
+    if(!table || !table->slots || !key_valid(table, key) || table->stride == 0) {
+        return 0;
+    }
+
+    u64 index = find_slot(table, hash_key(table, key), key);
+    return table->slots[index].hash ? value_at(table, index) : 0;
+}
+
+b8 hashtable_contains(hashtable* table, const void* key) {
+    if(!table || !table->slots || !key_valid(table, key)) {
+        return FALSE;
+    }
+
+    u64 index = find_slot(table, hash_key(table, key), key);
+    return table->slots[index].hash != 0;
+}
+
+b8 hashtable_remove(hashtable* table, const void* key) {
+    if(!table || !table->slots || !key_valid(table, key)) {
+        return FALSE;
+    }
+
+    u64 mask = table->capacity - 1;
+    u64 index = find_slot(table, hash_key(table, key), key);
+    if(!table->slots[index].hash) {
+        return FALSE;
+    }
+    free_key(table, &table->slots[index]);
+
+    // Backward-shift deletion: pull later entries of the probe chain into
+    // the hole so no tombstones are needed.
+    u64 hole = index;
+    u64 next = (index + 1) & mask;
+    while(table->slots[next].hash) {
+        u64 home = table->slots[next].hash & mask;
+        if(((next - home) & mask) >= ((next - hole) & mask)) {
+            table->slots[hole] = table->slots[next];
+            if(table->stride > 0) {
+                tcopy_memory(value_at(table, hole), value_at(table, next), table->stride);
+            }
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table->slots[hole].hash = 0;
+    table->slots[hole].key = 0;
+    table->count--;
+    return TRUE;
+}
+
+void hashtable_clear(hashtable* table) {
+    if(!table || !table->slots) {
+        return;
+    }
+
+    for(u64 i = 0; i < table->capacity; ++i) {
+        if(table->slots[i].hash) {
+            free_key(table, &table->slots[i]);
+        }
+    }
+    tzero_memory(table->slots, sizeof(hashtable_slot) * table->capacity);
+    table->count = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "defines.h"
+
+typedef enum hashtable_key_type {
+    // Keys are null-terminated strings. The table keeps its own copy.
+    HASHTABLE_KEY_STRING,
+    // Keys are compared by address (or any pointer-sized integer). 0 is a
+    // valid key.
+    HASHTABLE_KEY_POINTER
+} hashtable_key_type;
+
+struct hashtable_slot;
+
+// Open-addressing hash table with linear probing. Slots hold only the
+// 64-bit hash and the key (16 bytes, four per cache line); values of a
+// fixed stride live in a parallel array and are only touched on a hit.
+// Grows by doubling once the load factor passes 3/4.
+typedef struct hashtable {
+    u64 stride;
+    u64 capacity;
+    u64 count;
+    hashtable_key_type key_type;
+    struct hashtable_slot* slots;
+    void* values;
+} hashtable;
+
+// stride may be 0 to use the table as a set (see hashtable_contains).
+TAPI b8 hashtable_create(u64 stride, u64 initial_capacity, hashtable_key_type key_type, hashtable* out_table);
+TAPI void hashtable_destroy(hashtable* table);
+
+// Inserts or overwrites. key is a const char* or a pointer, matching the
+// table's key type; a null string key is rejected. value points to stride
+// bytes, or may be 0 for sets. Overwriting never grows the table.
+TAPI b8 hashtable_set(hashtable* table, const void* key, const void* value);
+
+// Returns a pointer to the stored value, valid until the next insert or
+// remove, or 0 if the key is not present.
+TAPI void* hashtable_get(hashtable* table, const void* key);
+
+TAPI b8 hashtable_contains(hashtable* table, const void* key);
+TAPI b8 hashtable_remove(hashtable* table, const void* key);
+TAPI void hashtable_clear(hashtable* table);
+
+#define hashtable_create_typed(type, initial_capacity, key_type, out_table) \
+    hashtable_create(sizeof(type), initial_capacity, key_type, out_table)
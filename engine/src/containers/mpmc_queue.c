@@ -0,0 +1,97 @@
+#include "containers/mpmc_queue.h"
+
+#include "core/tmemory.h"
+#include "core/logger.h"
+
+// Each cell is a u64 sequence followed by the element, padded to 8 bytes.
+#define CELL(queue, position) \
+    ((u64*)((u8*)(queue)->cells + ((position) & (queue)->mask) * (queue)->cell_size))
+
+b8 mpmc_queue_create(u64 stride, u64 capacity, mpmc_queue* out_queue) {
+    if(!out_queue || stride == 0 || capacity == 0) {
+        TERROR("mpmc_queue_create requires a non-zero stride and capacity.");
+        return FALSE;
+    }
+
+    u64 rounded = 2;
+    while(rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    tzero_memory(out_queue, sizeof(mpmc_queue));
+    out_queue->stride = stride;
+    out_queue->cell_size = sizeof(u64) + ((stride + 7) & ~(u64)7);
+    out_queue->mask = rounded - 1;
+    out_queue->cells = tallocate_aligned(out_queue->cell_size * rounded, MPMC_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+    if(!out_queue->cells) {
+        return FALSE;
+    }
+
+    for(u64 i = 0; i < rounded; ++i) {
+        *CELL(out_queue, i) = i;
+    }
+    return TRUE;
+}
+
+void mpmc_queue_destroy(mpmc_queue* queue) {
+    if(!queue) {
+        return;
+    }
+
+    if(queue->cells) {
+        tfree_aligned(queue->cells, queue->cell_size * (queue->mask + 1), MPMC_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+    }
+    tzero_memory(queue, sizeof(mpmc_queue));
+}
+
+b8 mpmc_queue_try_push(mpmc_queue* queue, const void* value) {
+    u64* cell;
+    u64 position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+    for(;;) {
+        cell = CELL(queue, position);
+        u64 sequence = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+        i64 difference = (i64)sequence - (i64)position;
+        if(difference == 0) {
+            if(__atomic_compare_exchange_n(&queue->enqueue_position, &position, position + 1, TRUE,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if(difference < 0) {
+            return FALSE;
+        } else {
+            position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    tcopy_memory(cell + 1, value, queue->stride);
+    __atomic_store_n(cell, position + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+b8 mpmc_queue_try_pop(mpmc_queue* queue, void* out_value) {
+    u64* cell;
+    u64 position = __atomic_load_n(&queue->dequeue_position, __ATOMIC_RELAXED);
+    for(;;) {
+        cell = CELL(queue, position);
+        u64 sequence = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+        i64 difference = (i64)sequence - (i64)(position + 1);
+        if(difference == 0) {
+            if(__atomic_compare_exchange_n(&queue->dequeue_position, &position, position + 1, TRUE,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if(difference < 0) {
+            return FALSE;
+        } else {
+            position = __atomic_load_n(&queue->dequeue_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    tcopy_memory(out_value, cell + 1, queue->stride);
+    __atomic_store_n(cell, position + queue->mask + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+u64 mpmc_queue_capacity(const mpmc_queue* queue) {
+    return queue->mask + 1;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "defines.h"
+
+#define MPMC_QUEUE_CACHE_LINE 64
+
+// Bounded lock-free multi-producer/multi-consumer queue (Vyukov). Every
+// cell carries a sequence number that tells producers and consumers
+// whether it is free to write or ready to read, so each operation is a
+// single CAS on the shared position plus a copy. Capacity is rounded up
+// to a power of two.
+typedef struct mpmc_queue {
+    u64 stride;
+    u64 cell_size;
+    u64 mask;
+    void* cells;
+    u8 padding0[MPMC_QUEUE_CACHE_LINE - 4 * sizeof(u64)];
+
+    u64 enqueue_position;
+    u8 padding1[MPMC_QUEUE_CACHE_LINE - sizeof(u64)];
+
+    u64 dequeue_position;
+    u8 padding2[MPMC_QUEUE_CACHE_LINE - sizeof(u64)];
+} mpmc_queue;
+
+TAPI b8 mpmc_queue_create(u64 stride, u64 capacity, mpmc_queue* out_queue);
+// Must not race with any push or pop.
+TAPI void mpmc_queue_destroy(mpmc_queue* queue);
+
+// Safe from any thread. Return FALSE when the queue is full/empty.
+TAPI b8 mpmc_queue_try_push(mpmc_queue* queue, const void* value);
+TAPI b8 mpmc_queue_try_pop(mpmc_queue* queue, void* out_value);
+TAPI u64 mpmc_queue_capacity(const mpmc_queue* queue);
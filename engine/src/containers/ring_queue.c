@@ -0,0 +1,149 @@
+#include "containers/ring_queue.h"
+
+#include "core/tmemory.h"
+#include "core/logger.h"
+
+b8 ring_queue_create(u64 stride, u64 capacity, void* memory, ring_queue* out_queue) {
+    if(!out_queue || stride == 0 || capacity == 0) {
+        TERROR("ring_queue_create requires a non-zero stride and capacity.");
+        return FALSE;
+    }
+
+    out_queue->stride = stride;
+    out_queue->capacity = capacity;
+    out_queue->length = 0;
+    out_queue->head = 0;
+    out_queue->tail = 0;
+    out_queue->owns_memory = memory == 0;
+    if(memory) {
+        out_queue->memory = memory;
+    } else {
+        out_queue->memory = tallocate_uninitialized(stride * capacity, MEMORY_TAG_RING_QUEUE);
+    }
+    return out_queue->memory != 0;
+}
+
+void ring_queue_destroy(ring_queue* queue) {
+    if(!queue) {
+        return;
+    }
+
+    if(queue->owns_memory && queue->memory) {
+        tfree(queue->memory, queue->stride * queue->capacity, MEMORY_TAG_RING_QUEUE);
+    }
+    tzero_memory(queue, sizeof(ring_queue));
+}
+
+b8 ring_queue_enqueue(ring_queue* queue, const void* value) {
+    if(queue->length == queue->capacity) {
+        return FALSE;
+    }
+
+    tcopy_memory((u8*)queue->memory + queue->tail * queue->stride, value, queue->stride);
+    queue->tail = (queue->tail + 1) % queue->capacity;
+    queue->length++;
+    return TRUE;
+}
+
+b8 ring_queue_dequeue(ring_queue* queue, void* out_value) {
+    if(queue->length == 0) {
+        return FALSE;
+    }
+
+    tcopy_memory(out_value, (u8*)queue->memory + queue->head * queue->stride, queue->stride);
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->length--;
+    return TRUE;
+}
+
+b8 ring_queue_peek(const ring_queue* queue, void* out_value) {
+    if(queue->length == 0) {
+        return FALSE;
+    }
+
+    tcopy_memory(out_value, (u8*)queue->memory + queue->head * queue->stride, queue->stride);
+    return TRUE;
+}
+
+b8 spsc_queue_create(u64 stride, u64 capacity, void* memory, spsc_queue* out_queue) {
+    if(!out_queue || stride == 0 || capacity == 0) {
+        TERROR("spsc_queue_create requires a non-zero stride and capacity.");
+        return FALSE;
+    }
+
+    u64 rounded = 1;
+    while(rounded < capacity) {
+        rounded <<= 1;
+    }
+    if(memory && rounded != capacity) {
+        TERROR("spsc_queue_create requires a power of two capacity when given memory.");
+        return FALSE;
+    }
+
+    tzero_memory(out_queue, sizeof(spsc_queue));
+    out_queue->stride = stride;
+    out_queue->mask = rounded - 1;
+    out_queue->owns_memory = memory == 0;
+    if(memory) {
+        out_queue->memory = memory;
+    } else {
+        out_queue->memory = tallocate_aligned(stride * rounded, SPSC_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+    }
+    return out_queue->memory != 0;
+}
+
+void spsc_queue_destroy(spsc_queue* queue) {
+    if(!queue) {
+        return;
+    }
+
+    if(queue->owns_memory && queue->memory) {
+        tfree_aligned(queue->memory, queue->stride * (queue->mask + 1), SPSC_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+    }
+    tzero_memory(queue, sizeof(spsc_queue));
+}
+
+b8 spsc_queue_try_push(spsc_queue* queue, const void* value) {
+    u64 head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    if(head - queue->cached_tail > queue->mask) {
+        queue->cached_tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+        if(head - queue->cached_tail > queue->mask) {
+            return FALSE;
+        }
+    }
+
+    tcopy_memory((u8*)queue->memory + (head & queue->mask) * queue->stride, value, queue->stride);
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+b8 spsc_queue_try_pop(spsc_queue* queue, void* out_value) {
+    u64 tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    if(tail == queue->cached_head) {
+        queue->cached_head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        if(tail == queue->cached_head) {
+            return FALSE;
+        }
+    }
+
+    tcopy_memory(out_value, (u8*)queue->memory + (tail & queue->mask) * queue->stride, queue->stride);
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+b8 spsc_queue_peek(spsc_queue* queue, void* out_value) {
+    u64 tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    if(tail == queue->cached_head) {
+        queue->cached_head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        if(tail == queue->cached_head) {
+            return FALSE;
+        }
+    }
+
+    tcopy_memory(out_value, (u8*)queue->memory + (tail & queue->mask) * queue->stride, queue->stride);
+    return TRUE;
+}
+
+u64 spsc_queue_capacity(const spsc_queue* queue) {
+    return queue->mask + 1;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "defines.h"
+
+// Fixed-capacity FIFO of stride-sized elements. Not thread-safe.
+typedef struct ring_queue {
+    u64 stride;
+    u64 capacity;
+    u64 length;
+    u64 head;
+    u64 tail;
+    void* memory;
+    b8 owns_memory;
+} ring_queue;
+
+// If memory is 0 the queue allocates stride * capacity bytes itself.
+TAPI b8 ring_queue_create(u64 stride, u64 capacity, void* memory, ring_queue* out_queue);
+TAPI void ring_queue_destroy(ring_queue* queue);
+
+TAPI b8 ring_queue_enqueue(ring_queue* queue, const void* value);
+TAPI b8 ring_queue_dequeue(ring_queue* queue, void* out_value);
+TAPI b8 ring_queue_peek(const ring_queue* queue, void* out_value);
+
+#define SPSC_QUEUE_CACHE_LINE 64
+
+// Lock-free single-producer/single-consumer ring. Exactly one thread may
+// push and exactly one (other) thread may pop. The producer and consumer
+// indices sit on separate cache lines and each side caches the other's
+// index, so the shared lines are only read when the queue looks full or
+// empty. Capacity is rounded up to a power of two.
+typedef struct spsc_queue {
+    u64 stride;
+    u64 mask;
+    void* memory;
+    b8 owns_memory;
+    u8 padding0[SPSC_QUEUE_CACHE_LINE - 3 * sizeof(u64) - sizeof(b8)];
+
+    // Written by the producer.
+    u64 head;
+    u64 cached_tail;
+    u8 padding1[SPSC_QUEUE_CACHE_LINE - 2 * sizeof(u64)];
+
+    // Written by the consumer.
+    u64 tail;
+    u64 cached_head;
+    u8 padding2[SPSC_QUEUE_CACHE_LINE - 2 * sizeof(u64)];
+} spsc_queue;
+
+// If memory is 0 the queue allocates its storage itself. Otherwise memory
+// holds stride * capacity bytes and capacity must be a power of two.
+TAPI b8 spsc_queue_create(u64 stride, u64 capacity, void* memory, spsc_queue* out_queue);
+TAPI void spsc_queue_destroy(spsc_queue* queue);
+
+// Producer side. Returns FALSE if the queue is full.
+TAPI b8 spsc_queue_try_push(spsc_queue* queue, const void* value);
+// Consumer side. Returns FALSE if the queue is empty.
+TAPI b8 spsc_queue_try_pop(spsc_queue* queue, void* out_value);
+// Consumer side. Copies the oldest element without removing it.
+TAPI b8 spsc_queue_peek(spsc_queue* queue, void* out_value);
+TAPI u64 spsc_queue_capacity(const spsc_queue* queue);
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "defines.h"
+#include "core/tmemory.h"
+#include "containers/darray.h"
+
+// Header-only, statically typed dynamic array. DARRAY_DEFINE(type)
+// generates darray_<type> with the length and capacity stored inline and
+// the element size known at compile time, so loops over .data compile to
+// plain array loops. type must be a single identifier (typedef pointers
+// and qualified types first). A zero-initialized darray_<type> is a valid
+// empty array.
+//
+// Example:
+//     DARRAY_DEFINE(vec3)
+//     darray_vec3 points = darray_vec3_create(64);
+//     darray_vec3_push(&points, v);
+//     for(u64 i = 0; i < points.length; ++i) { points.data[i] ... }
+//     darray_vec3_destroy(&points);
+
+#define DARRAY_DEFINE(type)                                                         \
+    typedef struct darray_##type {                                                  \
+        type* data;                                                                 \
+        u64 length;                                                                 \
+        u64 capacity;                                                               \
+    } darray_##type;                                                                \
+                                                                                    \
+    static inline b8 darray_##type##_set_capacity(darray_##type* array,             \
+        u64 capacity) {                                                             \
+        type* data = treallocate(array->data, array->capacity * sizeof(type),       \
+            capacity * sizeof(type), MEMORY_TAG_DARRAY);                            \
+        if(!data && capacity != 0) {                                                \
+            return FALSE;                                                           \
+        }                                                                           \
+        array->data = data;                                                         \
+        array->capacity = capacity;                                                 \
+        return TRUE;                                                                \
+    }                                                                               \
+                                                                                    \
+    static inline darray_##type darray_##type##_create(u64 capacity) {              \
+        darray_##type array = {0, 0, 0};                                            \
+        if(capacity > 0) {                                                          \
+            darray_##type##_set_capacity(&array, capacity);                         \
+        }                                                                           \
+        return array;                                                               \
+    }                                                                               \
+                                                                                    \
+    static inline void darray_##type##_destroy(darray_##type* array) {              \
+        if(array->data) {                                                           \
+            tfree(array->data, array->capacity * sizeof(type), MEMORY_TAG_DARRAY);  \
+        }                                                                           \
+        array->data = 0;                                                            \
+        array->length = 0;                                                          \
+        array->capacity = 0;                                                        \
+    }                                                                               \
+                                                                                    \
+    static inline void darray_##type##_reserve(darray_##type* array, u64 capacity) {\
+        if(capacity > array->capacity) {                                            \
+            darray_##type##_set_capacity(array, capacity);                          \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    static inline void darray_##type##_shrink_to_fit(darray_##type* array) {        \
+        if(array->length == 0) {                                                    \
+            darray_##type##_destroy(array);                                         \
+        } else if(array->length < array->capacity) {                                \
+            darray_##type##_set_capacity(array, array->length);                     \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    static inline b8 darray_##type##_grow(darray_##type* array, u64 required) {     \
+        u64 capacity = array->capacity * DARRAY_RESIZE_FACTOR;                      \
+        if(capacity < required) {                                                   \
+            capacity = required;                                                    \
+        }                                                                           \
+        if(capacity < DARRAY_MIN_CAPACITY) {                                        \
+            capacity = DARRAY_MIN_CAPACITY;                                         \
+        }                                                                           \
+        return darray_##type##_set_capacity(array, capacity);                       \
+    }                                                                               \
+                                                                                    \
+    static inline void darray_##type##_push(darray_##type* array, type value) {     \
+        if(array->length == array->capacity &&                                      \
+            !darray_##type##_grow(array, array->length + 1)) {                      \
+            return;                                                                 \
+        }                                                                           \
+        array->data[array->length++] = value;                                       \
+    }                                                                               \
+                                                                                    \
+    static inline void darray_##type##_push_range(darray_##type* array,             \
+        const type* values, u64 count) {                                            \
+        if(array->length + count > array->capacity &&                               \
+            !darray_##type##_grow(array, array->length + count)) {                  \
+            return;                                                                 \
+        }                                                                           \
+        tcopy_memory(array->data + array->length, values, count * sizeof(type));    \
+        array->length += count;                                                     \
+    }                                                                               \
+                                                                                    \
+    static inline type darray_##type##_pop(darray_##type* array) {                  \
+        return array->data[--array->length];                                        \
+    }                                                                               \
+                                                                                    \
+    static inline void darray_##type##_swap_remove(darray_##type* array, u64 index) {\
+        array->data[index] = array->data[--array->length];                          \
+    }                                                                               \
+                                                                                    \
+    static inline void darray_##type##_clear(darray_##type* array) {                \
+        array->length = 0;                                                          \
+    }
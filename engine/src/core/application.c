@@ -6,6 +6,7 @@
 #include "core/event.h"
 #include "core/input.h"
 #include "core/clock.h"
+#include "core/job_system.h"
 
 #include "renderer/renderer_frontend.h"
 
@@ -34,7 +35,19 @@ b8 application_create(game* game_inst) {
 
     app_state.game_inst = game_inst;
 
-    initialize_logging();
+    logger_config log_config = {};
+    log_config.file_path = game_inst->app_config.log_file_path ? game_inst->app_config.log_file_path : LOG_FILE_PATH;
+    log_config.binary_file_path = game_inst->app_config.binary_log_file_path ? game_inst->app_config.binary_log_file_path : LOG_BINARY_FILE_PATH;
+    log_config.file_buffer_size = LOG_FILE_BUFFER_SIZE;
+    log_config.flush_threshold = LOG_FILE_FLUSH_THRESHOLD;
+    log_config.flush_interval_ms = LOG_FILE_FLUSH_INTERVAL_MS;
+    log_config.max_file_size = LOG_FILE_MAX_SIZE;
+    log_config.max_rotations = LOG_FILE_MAX_ROTATIONS;
+    log_config.console_enabled = TRUE;
+    log_config.console_level = LOG_LEVEL_TRACE;
+    if(!initialize_logging(log_config)) {
+        TERROR("Logger failed to start its writer thread, logging synchronously.");
+    }
     input_initialize();
 
     app_state.is_running = TRUE;
@@ -45,6 +58,15 @@ b8 application_create(game* game_inst) {
         return FALSE;
     }
 
+    job_system_config job_config = {};
+    job_config.worker_count = JOB_SYSTEM_WORKER_COUNT;
+    job_config.fiber_count = JOB_SYSTEM_FIBER_COUNT;
+    job_config.fiber_stack_size = JOB_SYSTEM_FIBER_STACK_SIZE;
+    if(!job_system_initialize(job_config)) {
+        TERROR("Job system failed initialization. Application cannot contiue");
+        return FALSE;
+    }
+
     event_register(EVENT_CODE_APPLICATION_QUIT, 0, application_on_event);
     event_register(EVENT_CODE_KEY_PRESSED, 0, application_on_key);
     event_register(EVENT_CODE_KEY_RELEASED, 0, application_on_key);
@@ -87,12 +109,21 @@ b8 application_run() {
     // u8 frame_count = 0;
     f64 target_frame_seconds = 1.0f / 60;
 
-    TINFO(get_memory_usage_str());
+    char memory_usage[8000];
+    get_memory_usage(memory_usage, sizeof(memory_usage));
+    TINFO("%s", memory_usage);
 
     while(app_state.is_running) {
+        memory_frame_reset();
+        event_reclaim_snapshots();
+
         if(!platform_pump_messages(&app_state.platform)) {
             app_state.is_running = FALSE;
         }
+
+        // Everything posted since the last frame, including input gathered
+        // by the pump above.
+        event_dispatch_posted();
         if(!app_state.is_suspended) {
             clock_update(&app_state.clock);
             f64 current_time = app_state.clock.elapsed;
@@ -138,6 +169,8 @@ b8 application_run() {
     }
     app_state.is_running = FALSE;
 
+    job_system_shutdown();
+
     event_unregister(EVENT_CODE_APPLICATION_QUIT, 0, application_on_event);
     event_unregister(EVENT_CODE_KEY_PRESSED, 0, application_on_key);
     event_unregister(EVENT_CODE_KEY_RELEASED, 0, application_on_key);
@@ -149,6 +182,8 @@ b8 application_run() {
 
     platform_shutdown(&app_state.platform);
 
+    shutdown_logging();
+
     return TRUE;
 }
 
@@ -10,6 +10,10 @@ typedef struct application_config {
     i16 start_width;
     i16 start_height;
     char* name;
+    // 0 uses LOG_FILE_PATH.
+    const char* log_file_path;
+    // 0 uses LOG_BINARY_FILE_PATH.
+    const char* binary_log_file_path;
 } application_config;
 
 TAPI b8 application_create(struct game* game_inst);
@@ -1,42 +1,187 @@
 #include "core/event.h"
-#include "containers/darray.h"
 #include "core/tmemory.h"
+#include "core/logger.h"
+#include "containers/mpmc_queue.h"
 
-typedef struct registered_event {
-    void* listener;
-    PFN_on_event callback;
-} registered_event;
+#if TEVENT_INSTRUMENTATION
+#include "platform/platform.h"
+#endif
+
+// Immutable list of the listeners for one code. Callbacks and listeners
+// are parallel arrays stored in the same block, right after this header.
+// Registration publishes a new snapshot and retires the old one, so a
+// dispatch in flight keeps walking the list it started with.
+typedef struct event_listener_snapshot {
+    u32 count;
+    // Value of the reclaim epoch when it was replaced.
+    u64 retire_epoch;
+    struct event_listener_snapshot* next_retired;
+    PFN_on_event* callbacks;
+    void** listeners;
+} event_listener_snapshot;
 
 typedef struct event_code_entry {
-    registered_event* events;
+    event_listener_snapshot* snapshot;
+#if TEVENT_INSTRUMENTATION
+    event_code_stats stats;
+#endif
 } event_code_entry;
 
-#define MAX_MESSAGE_CODES 16384
+// Codes are looked up through a two-level table: the high byte picks a
+// page, allocated on first registration, and the low byte the entry.
+#define EVENT_PAGE_SIZE 256
+#define EVENT_PAGE_COUNT 256
+#define EVENT_POST_QUEUE_CAPACITY 1024
+// Dispatches that can be in flight at once, nested ones included, before
+// the rest fall back to blocking reclamation altogether.
+#define EVENT_DISPATCH_SLOTS 64
+#define EVENT_CACHE_LINE 64
+
+typedef struct event_code_page {
+    event_code_entry entries[EVENT_PAGE_SIZE];
+} event_code_page;
+
+typedef struct posted_event {
+    u16 code;
+    void* sender;
+    event_context context;
+} posted_event;
+
+// Holds the epoch a running dispatch started in, 0 when free. Slots are
+// claimed per dispatch rather than per thread, so nesting and handlers
+// that move to another thread (job fibers) need no bookkeeping.
+typedef struct event_dispatch_slot {
+    volatile u64 epoch;
+    u8 padding[EVENT_CACHE_LINE - sizeof(u64)];
+} event_dispatch_slot;
+
+#if TEVENT_INSTRUMENTATION
+typedef struct event_trace_entry {
+    f64 time;
+    void* sender;
+    u64 duration_ns;
+    u16 code;
+    u16 listeners_called;
+    b8 handled;
+} event_trace_entry;
+#endif
 
 typedef struct event_system_state {
-    event_code_entry registered[MAX_MESSAGE_CODES];
+    event_code_page* pages[EVENT_PAGE_COUNT];
+    mpmc_queue posted;
+    // Serializes register/unregister. Dispatch never takes it.
+    volatile i32 registry_lock;
+    // Advanced each time a snapshot is retired. A retired snapshot can be
+    // freed once every running dispatch started in a later epoch.
+    volatile u64 epoch;
+    event_dispatch_slot dispatch_slots[EVENT_DISPATCH_SLOTS];
+    // Dispatches that found no free slot. Nothing is freed while any run.
+    volatile i32 overflow_dispatches;
+    event_listener_snapshot* retired;
+#if TEVENT_INSTRUMENTATION
+    // Written without a lock, so entries racing with a dump can be torn.
+    event_trace_entry trace[EVENT_TRACE_CAPACITY];
+    volatile u64 trace_next;
+#endif
 } event_system_state;
 
 static b8 is_initialized = FALSE;
 static event_system_state state;
 
+static void registry_lock() {
+    while(__atomic_exchange_n(&state.registry_lock, 1, __ATOMIC_ACQUIRE)) {
+        while(__atomic_load_n(&state.registry_lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void registry_unlock() {
+    __atomic_store_n(&state.registry_lock, 0, __ATOMIC_RELEASE);
+}
+
+static event_code_entry* event_find_entry(u16 code) {
+    event_code_page* page = __atomic_load_n(&state.pages[code >> 8], __ATOMIC_ACQUIRE);
+    return page ? &page->entries[code & 0xFF] : 0;
+}
+
+// Registry lock must be held.
+static event_code_entry* event_get_entry(u16 code) {
+    event_code_page* page = state.pages[code >> 8];
+    if(page == 0) {
+        page = tallocate(sizeof(event_code_page), MEMORY_TAG_EVENT);
+        __atomic_store_n(&state.pages[code >> 8], page, __ATOMIC_RELEASE);
+    }
+    return &page->entries[code & 0xFF];
+}
+
+static u64 snapshot_size(u32 count) {
+    return sizeof(event_listener_snapshot) + count * (sizeof(PFN_on_event) + sizeof(void*));
+}
+
+static event_listener_snapshot* snapshot_create(u32 count) {
+    event_listener_snapshot* snapshot = tallocate_uninitialized(snapshot_size(count), MEMORY_TAG_EVENT);
+    snapshot->count = count;
+    snapshot->next_retired = 0;
+    snapshot->callbacks = (PFN_on_event*)(snapshot + 1);
+    snapshot->listeners = (void**)(snapshot->callbacks + count);
+    return snapshot;
+}
+
+static void snapshot_free(event_listener_snapshot* snapshot) {
+    tfree(snapshot, snapshot_size(snapshot->count), MEMORY_TAG_EVENT);
+}
+
+// Registry lock must be held. The old snapshot is freed by
+// event_reclaim_snapshots once no dispatch can still be reading it.
+static void snapshot_publish(event_code_entry* entry, event_listener_snapshot* snapshot) {
+    event_listener_snapshot* old = entry->snapshot;
+    __atomic_store_n(&entry->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    if(old) {
+        old->retire_epoch = __atomic_fetch_add(&state.epoch, 1, __ATOMIC_SEQ_CST);
+        old->next_retired = state.retired;
+        state.retired = old;
+    }
+}
+
 b8 event_initialize() {
     if(is_initialized == TRUE) {
         return FALSE;
     }
     is_initialized = FALSE;
     tzero_memory(&state, sizeof(state));
+    // 0 marks a free dispatch slot.
+    state.epoch = 1;
+    if(!mpmc_queue_create(sizeof(posted_event), EVENT_POST_QUEUE_CAPACITY, &state.posted)) {
+        return FALSE;
+    }
     is_initialized = TRUE;
     return TRUE;
 }
 
 void event_shutdown() {
-    for(u16 i = 0; i < MAX_MESSAGE_CODES; ++i) {
-        if(state.registered[i].events != 0) {
-            darray_destroy(state.registered[i].events);
-            state.registered[i].events = 0;
+    for(u32 i = 0; i < EVENT_PAGE_COUNT; ++i) {
+        event_code_page* page = state.pages[i];
+        if(page == 0) {
+            continue;
         }
+
+        for(u32 j = 0; j < EVENT_PAGE_SIZE; ++j) {
+            if(page->entries[j].snapshot) {
+                snapshot_free(page->entries[j].snapshot);
+            }
+        }
+        tfree(page, sizeof(event_code_page), MEMORY_TAG_EVENT);
+        state.pages[i] = 0;
+    }
+
+    while(state.retired) {
+        event_listener_snapshot* next = state.retired->next_retired;
+        snapshot_free(state.retired);
+        state.retired = next;
     }
+
+    mpmc_queue_destroy(&state.posted);
+    is_initialized = FALSE;
 }
 
 b8 event_register(u16 code, void* listener, PFN_on_event on_event) {
@@ -44,22 +189,27 @@ b8 event_register(u16 code, void* listener, PFN_on_event on_event) {
         return FALSE;
     }
 
-    if(state.registered[code].events == 0) {
-        state.registered[code].events = darray_create(registered_event);
-    }
-
-    u64 registered_count = darray_length(state.registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        if(state.registered[code].events[i].listener == listener) {
+    registry_lock();
+    event_code_entry* entry = event_get_entry(code);
+    event_listener_snapshot* current = entry->snapshot;
+    u32 count = current ? current->count : 0;
+    for(u32 i = 0; i < count; ++i) {
+        if(current->listeners[i] == listener) {
             // TODO: Warn
+            registry_unlock();
             return FALSE;
         }
     }
 
-    registered_event event;
-    event.listener = listener;
-    event.callback = on_event;
-    darray_push(state.registered[code].events, event);
+    event_listener_snapshot* snapshot = snapshot_create(count + 1);
+    if(count) {
+        tcopy_memory(snapshot->callbacks, current->callbacks, count * sizeof(PFN_on_event));
+        tcopy_memory(snapshot->listeners, current->listeners, count * sizeof(void*));
+    }
+    snapshot->callbacks[count] = on_event;
+    snapshot->listeners[count] = listener;
+    snapshot_publish(entry, snapshot);
+    registry_unlock();
 
     return TRUE;
 }
@@ -69,39 +219,264 @@ b8 event_unregister(u16 code, void* listener, PFN_on_event on_event) {
         return FALSE;
     }
 
-    if(state.registered[code].events == 0) {
+    registry_lock();
+    event_code_entry* entry = event_find_entry(code);
+    event_listener_snapshot* current = entry ? entry->snapshot : 0;
+    if(current == 0) {
         // TODO: Warn
+        registry_unlock();
         return FALSE;
     }
 
-    u64 registered_count = darray_length(state.registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        registered_event e = state.registered[code].events[i];
-        if(e.listener == listener && e.callback == on_event) {
-            registered_event popped_event;
-            darray_pop_at(state.registered[code].events, i, &popped_event);
+    for(u32 i = 0; i < current->count; ++i) {
+        if(current->listeners[i] == listener && current->callbacks[i] == on_event) {
+            // Keep registration order, it decides who handles an event first.
+            event_listener_snapshot* snapshot = 0;
+            if(current->count > 1) {
+                u32 remaining = current->count - i - 1;
+                snapshot = snapshot_create(current->count - 1);
+                tcopy_memory(snapshot->callbacks, current->callbacks, i * sizeof(PFN_on_event));
+                tcopy_memory(snapshot->callbacks + i, current->callbacks + i + 1, remaining * sizeof(PFN_on_event));
+                tcopy_memory(snapshot->listeners, current->listeners, i * sizeof(void*));
+                tcopy_memory(snapshot->listeners + i, current->listeners + i + 1, remaining * sizeof(void*));
+            }
+            snapshot_publish(entry, snapshot);
+            registry_unlock();
             return TRUE;
         }
     }
 
+    registry_unlock();
     return FALSE;
 }
 
+// Records the current epoch in a free slot before the snapshot is loaded,
+// so event_reclaim_snapshots either sees the dispatch or the dispatch sees
+// the newer snapshot. Returns the slot, or EVENT_DISPATCH_SLOTS on overflow.
+static u32 event_dispatch_begin() {
+    u64 epoch = __atomic_load_n(&state.epoch, __ATOMIC_SEQ_CST);
+    // Start from a stack-address hash so threads mostly probe different slots.
+    u32 start = (u32)((((u64)&epoch >> 12) * 0x9E3779B97F4A7C15ull) >> 58);
+    for(u32 i = 0; i < EVENT_DISPATCH_SLOTS; ++i) {
+        u32 index = (start + i) % EVENT_DISPATCH_SLOTS;
+        u64 expected = 0;
+        if(__atomic_load_n(&state.dispatch_slots[index].epoch, __ATOMIC_RELAXED) == 0 &&
+           __atomic_compare_exchange_n(&state.dispatch_slots[index].epoch, &expected, epoch, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            return index;
+        }
+    }
+
+    __atomic_fetch_add(&state.overflow_dispatches, 1, __ATOMIC_SEQ_CST);
+    return EVENT_DISPATCH_SLOTS;
+}
+
+static void event_dispatch_end(u32 slot) {
+    if(slot < EVENT_DISPATCH_SLOTS) {
+        __atomic_store_n(&state.dispatch_slots[slot].epoch, 0, __ATOMIC_RELEASE);
+    } else {
+        __atomic_fetch_sub(&state.overflow_dispatches, 1, __ATOMIC_RELEASE);
+    }
+}
+
+#if TEVENT_INSTRUMENTATION
+static void event_record_fire(event_code_entry* entry, u16 code, void* sender, u32 called, u64 total_ns, u64 max_ns, b8 handled, f64 time) {
+    event_code_stats* stats = &entry->stats;
+    __atomic_fetch_add(&stats->fire_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->listeners_called, called, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->total_handler_ns, total_ns, __ATOMIC_RELAXED);
+    u64 current_max = __atomic_load_n(&stats->max_handler_ns, __ATOMIC_RELAXED);
+    while(max_ns > current_max &&
+          !__atomic_compare_exchange_n(&stats->max_handler_ns, &current_max, max_ns, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    u64 slot = __atomic_fetch_add(&state.trace_next, 1, __ATOMIC_RELAXED) % EVENT_TRACE_CAPACITY;
+    event_trace_entry* trace = &state.trace[slot];
+    trace->time = time;
+    trace->sender = sender;
+    trace->duration_ns = total_ns;
+    trace->code = code;
+    trace->listeners_called = (u16)called;
+    trace->handled = handled;
+}
+#endif
+
 b8 event_fire(u16 code, void* sender, event_context context) {
     if(is_initialized == FALSE) {
         return FALSE;
     }
 
-    if(state.registered[code].events == 0) {
+    event_code_entry* entry = event_find_entry(code);
+    if(entry == 0) {
         return FALSE;
     }
 
-    u64 registered_count = darray_length(state.registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        registered_event e = state.registered[code].events[i];
-        if(e.callback(code, sender, e.listener, context)) {
-            return TRUE;
+    u32 slot = event_dispatch_begin();
+    event_listener_snapshot* snapshot = __atomic_load_n(&entry->snapshot, __ATOMIC_SEQ_CST);
+
+    b8 handled = FALSE;
+    u32 count = snapshot ? snapshot->count : 0;
+#if TEVENT_INSTRUMENTATION
+    f64 fire_time = platform_get_absolute_time();
+    f64 handler_start = fire_time;
+    u64 max_ns = 0;
+    u32 called = 0;
+#endif
+    for(u32 i = 0; i < count; ++i) {
+        b8 result = snapshot->callbacks[i](code, sender, snapshot->listeners[i], context);
+#if TEVENT_INSTRUMENTATION
+        f64 handler_end = platform_get_absolute_time();
+        u64 handler_ns = (u64)((handler_end - handler_start) * 1000000000.0);
+        max_ns = handler_ns > max_ns ? handler_ns : max_ns;
+        handler_start = handler_end;
+        called++;
+#endif
+        if(result) {
+            handled = TRUE;
+            break;
         }
     }
-    return FALSE;
-}
\ No newline at end of file
+
+#if TEVENT_INSTRUMENTATION
+    u64 total_ns = (u64)((handler_start - fire_time) * 1000000000.0);
+    event_record_fire(entry, code, sender, called, total_ns, max_ns, handled, fire_time);
+#endif
+
+    event_dispatch_end(slot);
+    return handled;
+}
+
+void event_reclaim_snapshots() {
+    if(is_initialized == FALSE) {
+        return;
+    }
+
+    registry_lock();
+    event_listener_snapshot* retired = state.retired;
+    state.retired = 0;
+    registry_unlock();
+
+    if(retired == 0) {
+        return;
+    }
+
+    // A dispatch that claims a slot after this scan loads a newer snapshot,
+    // so only the ones already running can hold a retired one, and only if
+    // they started no later than it was retired.
+    u64 oldest = __atomic_load_n(&state.epoch, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&state.overflow_dispatches, __ATOMIC_SEQ_CST) != 0) {
+        oldest = 0;
+    }
+    for(u32 i = 0; i < EVENT_DISPATCH_SLOTS; ++i) {
+        u64 epoch = __atomic_load_n(&state.dispatch_slots[i].epoch, __ATOMIC_SEQ_CST);
+        if(epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    // Anything still in use is put back for the next frame.
+    event_listener_snapshot* kept = 0;
+    event_listener_snapshot* kept_last = 0;
+    while(retired) {
+        event_listener_snapshot* next = retired->next_retired;
+        if(retired->retire_epoch < oldest) {
+            snapshot_free(retired);
+        } else {
+            retired->next_retired = kept;
+            kept = retired;
+            if(!kept_last) {
+                kept_last = retired;
+            }
+        }
+        retired = next;
+    }
+
+    if(kept) {
+        registry_lock();
+        kept_last->next_retired = state.retired;
+        state.retired = kept;
+        registry_unlock();
+    }
+}
+
+b8 event_post(u16 code, void* sender, event_context context) {
+    if(is_initialized == FALSE) {
+        return FALSE;
+    }
+
+    posted_event event;
+    event.code = code;
+    event.sender = sender;
+    event.context = context;
+    if(!mpmc_queue_try_push(&state.posted, &event)) {
+        TWARN("Event queue is full, dropping event code %u.", code);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void event_dispatch_posted() {
+    if(is_initialized == FALSE) {
+        return;
+    }
+
+    // Bounded so listeners that post again cannot keep the frame here.
+    u64 capacity = mpmc_queue_capacity(&state.posted);
+    posted_event event;
+    for(u64 i = 0; i < capacity && mpmc_queue_try_pop(&state.posted, &event); ++i) {
+        event_fire(event.code, event.sender, event.context);
+    }
+}
+
+#if TEVENT_INSTRUMENTATION
+b8 event_get_stats(u16 code, event_code_stats* out_stats) {
+    event_code_entry* entry = is_initialized ? event_find_entry(code) : 0;
+    if(entry == 0) {
+        tzero_memory(out_stats, sizeof(event_code_stats));
+        return FALSE;
+    }
+
+    out_stats->fire_count = __atomic_load_n(&entry->stats.fire_count, __ATOMIC_RELAXED);
+    out_stats->listeners_called = __atomic_load_n(&entry->stats.listeners_called, __ATOMIC_RELAXED);
+    out_stats->total_handler_ns = __atomic_load_n(&entry->stats.total_handler_ns, __ATOMIC_RELAXED);
+    out_stats->max_handler_ns = __atomic_load_n(&entry->stats.max_handler_ns, __ATOMIC_RELAXED);
+    return TRUE;
+}
+
+void event_dump_stats() {
+    if(is_initialized == FALSE) {
+        return;
+    }
+
+    TINFO("Event stats (code: fires, listeners called, total/max handler time):");
+    for(u32 i = 0; i < EVENT_PAGE_COUNT; ++i) {
+        event_code_page* page = __atomic_load_n(&state.pages[i], __ATOMIC_ACQUIRE);
+        if(page == 0) {
+            continue;
+        }
+
+        for(u32 j = 0; j < EVENT_PAGE_SIZE; ++j) {
+            u16 code = (u16)((i << 8) | j);
+            event_code_stats stats;
+            if(event_get_stats(code, &stats) && stats.fire_count > 0) {
+                TINFO("  0x%04x: %llu, %llu, %.3fms/%.3fms", code, stats.fire_count, stats.listeners_called,
+                      stats.total_handler_ns / 1000000.0, stats.max_handler_ns / 1000000.0);
+            }
+        }
+    }
+}
+
+void event_dump_trace() {
+    if(is_initialized == FALSE) {
+        return;
+    }
+
+    u64 next = __atomic_load_n(&state.trace_next, __ATOMIC_RELAXED);
+    u64 count = next < EVENT_TRACE_CAPACITY ? next : EVENT_TRACE_CAPACITY;
+    TERROR("Last %llu events (time, code, sender, listeners called, handled, handler time):", count);
+    for(u64 i = next - count; i < next; ++i) {
+        event_trace_entry* trace = &state.trace[i % EVENT_TRACE_CAPACITY];
+        TERROR("  %.6f 0x%04x %p %u %u %lluns", trace->time, trace->code, trace->sender,
+               trace->listeners_called, trace->handled, trace->duration_ns);
+    }
+}
+#endif
\ No newline at end of file
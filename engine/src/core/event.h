@@ -22,15 +22,53 @@ typedef struct event_context {
     } data;
 } event_context;
 
+// Set to 1 to count fires, listener calls and handler time per code and
+// keep a trace of the last EVENT_TRACE_CAPACITY dispatches. At 0 none of
+// it is compiled in.
+#ifndef TEVENT_INSTRUMENTATION
+#define TEVENT_INSTRUMENTATION 0
+#endif
+
+#define EVENT_TRACE_CAPACITY 256
+
 typedef b8 (*PFN_on_event)(u16 code, void* sender, void* listener_inst, event_context data);
 
-b8 event_initialize();
-void event_shutdown();
+// Exported along with event_reclaim_snapshots for tools/event_stress.
+TAPI b8 event_initialize();
+TAPI void event_shutdown();
 
+// Register, unregister and fire are safe from any thread. A dispatch
+// already in progress keeps the listener list it started with.
 TAPI b8 event_register(u16 code, void* listener, PFN_on_event on_event);
 TAPI b8 event_unregister(u16 code, void* listener, PFN_on_event on_event);
 TAPI b8 event_fire(u16 code, void* sender, event_context context);
 
+// Queues the event for the next event_dispatch_posted instead of calling
+// the listeners now. Safe from any thread. Returns FALSE if the queue is
+// full and the event was dropped.
+TAPI b8 event_post(u16 code, void* sender, event_context context);
+// Fires every queued event in posting order. Called once per frame by the
+// application.
+void event_dispatch_posted();
+// Frees listener lists replaced by register/unregister once no dispatch
+// can still be using them. Called by the application between frames.
+TAPI void event_reclaim_snapshots();
+
+#if TEVENT_INSTRUMENTATION
+typedef struct event_code_stats {
+    u64 fire_count;
+    u64 listeners_called;
+    u64 total_handler_ns;
+    u64 max_handler_ns;
+} event_code_stats;
+
+// Only codes with registered listeners are recorded.
+TAPI b8 event_get_stats(u16 code, event_code_stats* out_stats);
+// Log the stats of every recorded code / the trace, oldest first.
+TAPI void event_dump_stats();
+TAPI void event_dump_trace();
+#endif
+
 typedef enum system_event_code {
     EVENT_CODE_APPLICATION_QUIT = 0x01,
     EVENT_CODE_KEY_PRESSED = 0x02,
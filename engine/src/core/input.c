@@ -51,7 +51,7 @@ void input_process_key(keys key, b8 pressed) {
 
         event_context context;
         context.data.u16[0] = key;
-        event_fire(pressed ? EVENT_CODE_KEY_PRESSED : EVENT_CODE_KEY_RELEASED,
+        event_post(pressed ? EVENT_CODE_KEY_PRESSED : EVENT_CODE_KEY_RELEASED,
             0, context);
     }
 }
@@ -62,7 +62,7 @@ void input_process_button(buttons button, b8 pressed) {
 
         event_context context;
         context.data.u16[0] = button;
-        event_fire(pressed ? EVENT_CODE_BUTTON_PRESSED : EVENT_CODE_BUTTON_RELEASED,
+        event_post(pressed ? EVENT_CODE_BUTTON_PRESSED : EVENT_CODE_BUTTON_RELEASED,
             0, context);
     }
 }
@@ -78,7 +78,7 @@ void input_process_mouse_move(i16 x, i16 y) {
         event_context context;
         context.data.u16[0] = x;
         context.data.u16[1] = y;
-        event_fire(EVENT_CODE_MOUSE_MOVED, 0, context);
+        event_post(EVENT_CODE_MOUSE_MOVED, 0, context);
     }
 }
 
@@ -87,7 +87,7 @@ void input_process_mouse_wheel(i8 z_delta) {
 
     event_context context;
     context.data.u8[0] = z_delta;
-    event_fire(EVENT_CODE_MOUSE_MOVED, 0, context);
+    event_post(EVENT_CODE_MOUSE_MOVED, 0, context);
 }
 
 b8 input_is_key_down(keys key) {
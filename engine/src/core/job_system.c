@@ -0,0 +1,638 @@
+#include "core/job_system.h"
+
+#include "core/logger.h"
+#include "core/tmemory.h"
+#include "containers/mpmc_queue.h"
+#include "memory/pool_allocator.h"
+#include "platform/platform.h"
+
+#define JOB_CACHE_LINE 64
+#define JOB_POOL_CHUNK_SIZE 1024
+
+typedef struct job {
+    PFN_job_entry entry;
+    void* param;
+    job_counter* counter;
+    // Links jobs waiting on a dependency counter.
+    struct job* next;
+} job;
+
+// Chase-Lev work-stealing deque with a fixed capacity. The owning thread
+// pushes and pops at the bottom, any other thread steals from the top.
+typedef struct job_deque {
+    volatile i64 top;
+    u8 padding0[JOB_CACHE_LINE - sizeof(i64)];
+    volatile i64 bottom;
+    u8 padding1[JOB_CACHE_LINE - sizeof(i64)];
+    job* entries[JOB_DEQUE_CAPACITY];
+} job_deque;
+
+typedef struct job_fiber {
+    platform_fiber fiber;
+    void* stack;
+    // Links fibers parked on the same counter.
+    struct job_fiber* next;
+} job_fiber;
+
+typedef struct thread_context {
+    i32 index;
+    // The thread's own stack, converted so it can switch to pool fibers.
+    platform_fiber thread_fiber;
+    // Pool fiber running on this thread, 0 when not in fiber mode.
+    job_fiber* current;
+    // A fiber cannot hand itself to other threads while it is still
+    // running, so the next fiber on the thread does it after the switch.
+    job_fiber* pending_free;
+    job_fiber* pending_ready;
+    // Lock of the counter the previous fiber parked on, held across the
+    // switch so nobody resumes it before it has stopped running.
+    volatile i32* pending_unlock;
+} thread_context;
+
+typedef struct job_system_state {
+    // Index 0 is the main thread, 1..thread_count-1 are workers.
+    u32 thread_count;
+    platform_thread* threads;
+    job_deque* deques;
+    // Submissions from threads that do not own a deque, and overflow.
+    mpmc_queue injection_queue;
+    platform_semaphore wake_semaphore;
+    volatile i32 sleeping_count;
+    volatile b8 running;
+    pool_allocator job_pool;
+    volatile i32 pool_lock;
+
+    u32 fiber_count;
+    u64 fiber_stack_size;
+    job_fiber* fibers;
+    mpmc_queue free_fibers;
+    mpmc_queue ready_fibers;
+    // Fibers parked on a counter or waiting to be resumed.
+    volatile i32 parked_count;
+} job_system_state;
+
+static b8 is_initialized = FALSE;
+static job_system_state state;
+static _Thread_local thread_context thread_ctx = {-1};
+
+// Fibers can resume on another thread, so the thread-local address must
+// be looked up again after every switch rather than kept by the compiler.
+static TNOINLINE thread_context* get_thread_context() {
+    thread_context* ctx = &thread_ctx;
+    __asm__ volatile("" : "+r"(ctx));
+    return ctx;
+}
+
+static void spin_lock(volatile i32* lock) {
+    while(__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+        while(__atomic_load_n(lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void spin_unlock(volatile i32* lock) {
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+static b8 deque_push(job_deque* deque, job* j) {
+    i64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    i64 top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    if(bottom - top >= JOB_DEQUE_CAPACITY) {
+        return FALSE;
+    }
+
+    __atomic_store_n(&deque->entries[bottom & (JOB_DEQUE_CAPACITY - 1)], j, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+static job* deque_pop(job_deque* deque) {
+    i64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    i64 top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+    if(top > bottom) {
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    job* j = __atomic_load_n(&deque->entries[bottom & (JOB_DEQUE_CAPACITY - 1)], __ATOMIC_RELAXED);
+    if(top == bottom) {
+        // Last entry, race the thieves for it.
+        if(!__atomic_compare_exchange_n(&deque->top, &top, top + 1, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            j = 0;
+        }
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return j;
+}
+
+static job* deque_steal(job_deque* deque) {
+    i64 top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    i64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if(top >= bottom) {
+        return 0;
+    }
+
+    job* j = __atomic_load_n(&deque->entries[top & (JOB_DEQUE_CAPACITY - 1)], __ATOMIC_RELAXED);
+    if(!__atomic_compare_exchange_n(&deque->top, &top, top + 1, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    return j;
+}
+
+static job* job_allocate() {
+    spin_lock(&state.pool_lock);
+    job* j = pool_allocator_allocate_typed(job, &state.job_pool);
+    spin_unlock(&state.pool_lock);
+    return j;
+}
+
+static void job_release(job* j) {
+    spin_lock(&state.pool_lock);
+    pool_allocator_free(&state.job_pool, j);
+    spin_unlock(&state.pool_lock);
+}
+
+static void job_execute(job* j);
+
+// Pairs with the fence in worker_loop, so either the worker sees the new
+// work before sleeping or it is counted here and woken.
+static void wake_workers(u32 count) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    i32 sleeping = __atomic_load_n(&state.sleeping_count, __ATOMIC_RELAXED);
+    if(sleeping > 0 && count > 0) {
+        platform_semaphore_signal(&state.wake_semaphore, count < (u32)sleeping ? count : (u32)sleeping);
+    }
+}
+
+static void enqueue_jobs(job* first) {
+    u32 count = 0;
+    while(first) {
+        job* j = first;
+        first = first->next;
+        j->next = 0;
+
+        // Looked up each time, running a job inline may move us to another thread.
+        i32 thread_index = get_thread_context()->index;
+        if(thread_index >= 0 && deque_push(&state.deques[thread_index], j)) {
+            ++count;
+        } else if(mpmc_queue_try_push(&state.injection_queue, &j)) {
+            ++count;
+        } else {
+            // Everything is full, so make progress here instead of blocking.
+            job_execute(j);
+        }
+    }
+
+    wake_workers(count);
+}
+
+static void make_fibers_ready(job_fiber* first) {
+    u32 count = 0;
+    while(first) {
+        job_fiber* f = first;
+        first = first->next;
+        f->next = 0;
+        // Sized for every fiber, so this cannot fail.
+        mpmc_queue_try_push(&state.ready_fibers, &f);
+        ++count;
+    }
+
+    wake_workers(count);
+}
+
+static void counter_add(job_counter* counter, i32 amount) {
+    __atomic_fetch_add(&counter->value, amount, __ATOMIC_RELAXED);
+}
+
+// Only the decrement that reaches zero takes the lock, so a waiter that
+// sees zero knows the last completer is done with the counter once the
+// lock is released.
+static void counter_decrement(job_counter* counter) {
+    i32 value = __atomic_load_n(&counter->value, __ATOMIC_RELAXED);
+    while(value > 1) {
+        if(__atomic_compare_exchange_n(&counter->value, &value, value - 1, TRUE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+
+    job* released = 0;
+    job_fiber* resumed = 0;
+    spin_lock(&counter->lock);
+    if(__atomic_sub_fetch(&counter->value, 1, __ATOMIC_ACQ_REL) == 0) {
+        released = counter->waiters;
+        counter->waiters = 0;
+        resumed = counter->parked_fibers;
+        counter->parked_fibers = 0;
+    }
+    spin_unlock(&counter->lock);
+
+    if(released) {
+        enqueue_jobs(released);
+    }
+    if(resumed) {
+        make_fibers_ready(resumed);
+    }
+}
+
+static void job_execute(job* j) {
+    j->entry(j->param);
+    job_counter* counter = j->counter;
+    job_release(j);
+    if(counter) {
+        counter_decrement(counter);
+    }
+}
+
+static job* find_job() {
+    i32 thread_index = get_thread_context()->index;
+    job* j = 0;
+    if(thread_index >= 0) {
+        j = deque_pop(&state.deques[thread_index]);
+        if(j) {
+            return j;
+        }
+    }
+
+    if(mpmc_queue_try_pop(&state.injection_queue, &j)) {
+        return j;
+    }
+
+    u32 start = thread_index >= 0 ? (u32)thread_index + 1 : 0;
+    for(u32 i = 0; i < state.thread_count; ++i) {
+        u32 victim = (start + i) % state.thread_count;
+        if((i32)victim == thread_index) {
+            continue;
+        }
+        j = deque_steal(&state.deques[victim]);
+        if(j) {
+            return j;
+        }
+    }
+    return 0;
+}
+
+// Runs on the fiber that just gained control of the thread.
+static void finish_fiber_switch() {
+    thread_context* ctx = get_thread_context();
+    if(ctx->pending_free) {
+        mpmc_queue_try_push(&state.free_fibers, &ctx->pending_free);
+        ctx->pending_free = 0;
+    }
+
+    if(ctx->pending_ready) {
+        job_fiber* f = ctx->pending_ready;
+        ctx->pending_ready = 0;
+        make_fibers_ready(f);
+    }
+
+    // Last touch of the counter: until this store it cannot reach zero, so
+    // its owner cannot have returned from job_wait yet.
+    if(ctx->pending_unlock) {
+        volatile i32* lock = ctx->pending_unlock;
+        ctx->pending_unlock = 0;
+        spin_unlock(lock);
+    }
+}
+
+// Hands the thread to f. Returns once this fiber is picked up again.
+static void switch_to_fiber(job_fiber* f) {
+    thread_context* ctx = get_thread_context();
+    job_fiber* self = ctx->current;
+    ctx->current = f;
+    platform_fiber_switch(&self->fiber, &f->fiber);
+    finish_fiber_switch();
+}
+
+static job_fiber* find_ready_fiber() {
+    job_fiber* f = 0;
+    if(get_thread_context()->current && mpmc_queue_try_pop(&state.ready_fibers, &f)) {
+        return f;
+    }
+    return 0;
+}
+
+static void worker_loop() {
+    while(__atomic_load_n(&state.running, __ATOMIC_ACQUIRE)) {
+        // Resuming parked work first keeps the number of live fibers down.
+        job_fiber* f = find_ready_fiber();
+        if(f) {
+            get_thread_context()->pending_free = get_thread_context()->current;
+            switch_to_fiber(f);
+            continue;
+        }
+
+        job* j = find_job();
+        if(j) {
+            job_execute(j);
+            continue;
+        }
+
+        __atomic_fetch_add(&state.sleeping_count, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        f = find_ready_fiber();
+        if(f) {
+            __atomic_fetch_sub(&state.sleeping_count, 1, __ATOMIC_RELAXED);
+            get_thread_context()->pending_free = get_thread_context()->current;
+            switch_to_fiber(f);
+            continue;
+        }
+        j = find_job();
+        if(j) {
+            __atomic_fetch_sub(&state.sleeping_count, 1, __ATOMIC_RELAXED);
+            job_execute(j);
+            continue;
+        }
+
+        platform_semaphore_wait(&state.wake_semaphore);
+        __atomic_fetch_sub(&state.sleeping_count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void fiber_main(void* param) {
+    finish_fiber_switch();
+    worker_loop();
+
+    // Shutting down, give the thread back to its own stack. The fiber stays
+    // out of the free queue: a worker that only starts now could pick it up
+    // and resume it past this point.
+    thread_context* ctx = get_thread_context();
+    job_fiber* self = ctx->current;
+    ctx->current = 0;
+    platform_fiber_switch(&self->fiber, &ctx->thread_fiber);
+}
+
+static u32 worker_thread_main(void* param) {
+    thread_context* ctx = get_thread_context();
+    ctx->index = (i32)(u64)param;
+
+    job_fiber* f = 0;
+    if(state.fiber_count > 0 && mpmc_queue_try_pop(&state.free_fibers, &f)) {
+        if(platform_fiber_convert_thread(&ctx->thread_fiber)) {
+            ctx->current = f;
+            platform_fiber_switch(&ctx->thread_fiber, &f->fiber);
+            finish_fiber_switch();
+            platform_fiber_revert_thread(&get_thread_context()->thread_fiber);
+            return 0;
+        }
+        mpmc_queue_try_push(&state.free_fibers, &f);
+    }
+
+    worker_loop();
+    return 0;
+}
+
+static b8 create_fibers() {
+    state.fibers = tallocate(sizeof(job_fiber) * state.fiber_count, MEMORY_TAG_JOB);
+    if(!mpmc_queue_create(sizeof(job_fiber*), state.fiber_count, &state.free_fibers) ||
+       !mpmc_queue_create(sizeof(job_fiber*), state.fiber_count, &state.ready_fibers)) {
+        return FALSE;
+    }
+
+    b8 needs_stack = platform_fiber_requires_stack_memory();
+    for(u32 i = 0; i < state.fiber_count; ++i) {
+        job_fiber* f = &state.fibers[i];
+        if(needs_stack) {
+            f->stack = tallocate_aligned(state.fiber_stack_size, 16, MEMORY_TAG_JOB);
+        }
+        if(!platform_fiber_create(state.fiber_stack_size, f->stack, fiber_main, 0, &f->fiber)) {
+            return FALSE;
+        }
+        mpmc_queue_try_push(&state.free_fibers, &f);
+    }
+    return TRUE;
+}
+
+static void destroy_fibers() {
+    if(!state.fibers) {
+        return;
+    }
+
+    for(u32 i = 0; i < state.fiber_count; ++i) {
+        job_fiber* f = &state.fibers[i];
+        platform_fiber_destroy(&f->fiber);
+        if(f->stack) {
+            tfree_aligned(f->stack, state.fiber_stack_size, 16, MEMORY_TAG_JOB);
+        }
+    }
+    mpmc_queue_destroy(&state.ready_fibers);
+    mpmc_queue_destroy(&state.free_fibers);
+    tfree(state.fibers, sizeof(job_fiber) * state.fiber_count, MEMORY_TAG_JOB);
+    state.fibers = 0;
+}
+
+b8 job_system_initialize(job_system_config config) {
+    if(is_initialized) {
+        TERROR("job_system_initialize called more than once.");
+        return FALSE;
+    }
+
+    u32 worker_count = config.worker_count;
+    if(worker_count == 0) {
+        u32 processor_count = platform_get_processor_count();
+        worker_count = processor_count > 1 ? processor_count - 1 : 1;
+    }
+
+    tzero_memory(&state, sizeof(state));
+    state.thread_count = worker_count + 1;
+    state.fiber_count = config.fiber_count;
+    state.fiber_stack_size = config.fiber_stack_size ? config.fiber_stack_size : JOB_SYSTEM_FIBER_STACK_SIZE;
+
+    if(!pool_allocator_create_typed(job, JOB_POOL_CHUNK_SIZE, TRUE, MEMORY_TAG_JOB, &state.job_pool)) {
+        return FALSE;
+    }
+    if(!mpmc_queue_create(sizeof(job*), JOB_INJECTION_QUEUE_CAPACITY, &state.injection_queue)) {
+        return FALSE;
+    }
+    // Spare wakeups are harmless, so leave the count effectively unbounded.
+    if(!platform_semaphore_create(0, 0x7FFFFFFF, &state.wake_semaphore)) {
+        return FALSE;
+    }
+
+    state.deques = tallocate_aligned(sizeof(job_deque) * state.thread_count, JOB_CACHE_LINE, MEMORY_TAG_JOB);
+    state.threads = tallocate(sizeof(platform_thread) * state.thread_count, MEMORY_TAG_JOB);
+    if(state.fiber_count > 0 && !create_fibers()) {
+        TERROR("Failed to create the job fiber pool.");
+        return FALSE;
+    }
+
+    get_thread_context()->index = 0;
+    state.running = TRUE;
+    is_initialized = TRUE;
+
+    for(u32 i = 1; i < state.thread_count; ++i) {
+        if(!platform_thread_create(worker_thread_main, (void*)(u64)i, &state.threads[i])) {
+            TERROR("Failed to start job worker %u.", i);
+            job_system_shutdown();
+            return FALSE;
+        }
+    }
+
+    TINFO("Job system started with %u worker threads and %u fibers.", worker_count, state.fiber_count);
+    return TRUE;
+}
+
+void job_system_shutdown() {
+    if(!is_initialized) {
+        return;
+    }
+
+    // Drain whatever is still queued so counters held by callers settle.
+    // Parked fibers can only be resumed by the workers, so keep them
+    // running until those have finished too.
+    job* j;
+    for(;;) {
+        while((j = find_job())) {
+            job_execute(j);
+        }
+        if(__atomic_load_n(&state.parked_count, __ATOMIC_ACQUIRE) == 0) {
+            break;
+        }
+        platform_sleep(0);
+    }
+
+    __atomic_store_n(&state.running, FALSE, __ATOMIC_RELEASE);
+    platform_semaphore_signal(&state.wake_semaphore, state.thread_count);
+    for(u32 i = 1; i < state.thread_count; ++i) {
+        platform_thread_join(&state.threads[i]);
+    }
+
+    // Workers may have queued follow-up jobs before they stopped.
+    while((j = find_job())) {
+        job_execute(j);
+    }
+
+    tfree(state.threads, sizeof(platform_thread) * state.thread_count, MEMORY_TAG_JOB);
+    tfree_aligned(state.deques, sizeof(job_deque) * state.thread_count, JOB_CACHE_LINE, MEMORY_TAG_JOB);
+    platform_semaphore_destroy(&state.wake_semaphore);
+    mpmc_queue_destroy(&state.injection_queue);
+    pool_allocator_destroy(&state.job_pool);
+    destroy_fibers();
+
+    get_thread_context()->index = -1;
+    is_initialized = FALSE;
+}
+
+u32 job_system_thread_count() {
+    return is_initialized ? state.thread_count : 1;
+}
+
+static job* build_jobs(const job_decl* jobs, u32 count, job_counter* counter) {
+    job* first = 0;
+    for(u32 i = count; i > 0; --i) {
+        job* j = job_allocate();
+        j->entry = jobs[i - 1].entry;
+        j->param = jobs[i - 1].param;
+        j->counter = counter;
+        j->next = first;
+        first = j;
+    }
+    return first;
+}
+
+void job_submit(const job_decl* jobs, u32 count, job_counter* counter) {
+    if(count == 0) {
+        return;
+    }
+
+    if(!is_initialized) {
+        // Nothing to hand the work to, run it in place.
+        for(u32 i = 0; i < count; ++i) {
+            jobs[i].entry(jobs[i].param);
+        }
+        return;
+    }
+
+    if(counter) {
+        counter_add(counter, (i32)count);
+    }
+    enqueue_jobs(build_jobs(jobs, count, counter));
+}
+
+void job_submit_after(job_counter* dependency, const job_decl* jobs, u32 count, job_counter* counter) {
+    if(!dependency) {
+        job_submit(jobs, count, counter);
+        return;
+    }
+    if(count == 0) {
+        return;
+    }
+
+    if(!is_initialized) {
+        job_wait(dependency);
+        job_submit(jobs, count, counter);
+        return;
+    }
+
+    if(counter) {
+        counter_add(counter, (i32)count);
+    }
+    job* first = build_jobs(jobs, count, counter);
+
+    spin_lock(&dependency->lock);
+    if(__atomic_load_n(&dependency->value, __ATOMIC_ACQUIRE) != 0) {
+        job* last = first;
+        while(last->next) {
+            last = last->next;
+        }
+        last->next = dependency->waiters;
+        dependency->waiters = first;
+        first = 0;
+    }
+    spin_unlock(&dependency->lock);
+
+    if(first) {
+        enqueue_jobs(first);
+    }
+}
+
+b8 job_counter_is_done(job_counter* counter) {
+    return __atomic_load_n(&counter->value, __ATOMIC_ACQUIRE) == 0 &&
+           __atomic_load_n(&counter->lock, __ATOMIC_ACQUIRE) == 0;
+}
+
+void job_wait(job_counter* counter) {
+    thread_context* ctx = get_thread_context();
+    if(ctx->current && !job_counter_is_done(counter)) {
+        job_fiber* next = 0;
+        if(mpmc_queue_try_pop(&state.free_fibers, &next)) {
+            spin_lock(&counter->lock);
+            if(__atomic_load_n(&counter->value, __ATOMIC_ACQUIRE) != 0) {
+                __atomic_fetch_add(&state.parked_count, 1, __ATOMIC_RELAXED);
+                ctx->current->next = counter->parked_fibers;
+                counter->parked_fibers = ctx->current;
+                ctx->pending_unlock = &counter->lock;
+                switch_to_fiber(next);
+                __atomic_fetch_sub(&state.parked_count, 1, __ATOMIC_RELEASE);
+            } else {
+                spin_unlock(&counter->lock);
+                mpmc_queue_try_push(&state.free_fibers, &next);
+            }
+        }
+        // Without a spare fiber, fall back to helping below.
+    }
+
+    while(!job_counter_is_done(counter)) {
+        job* j = is_initialized ? find_job() : 0;
+        if(j) {
+            job_execute(j);
+            continue;
+        }
+
+        // Parked fibers may be what the counter is waiting for, and with
+        // the pool used up nobody else might be free to resume them. Yield
+        // to one and come back through the ready queue.
+        job_fiber* f = is_initialized ? find_ready_fiber() : 0;
+        if(f) {
+            __atomic_fetch_add(&state.parked_count, 1, __ATOMIC_RELAXED);
+            get_thread_context()->pending_ready = get_thread_context()->current;
+            switch_to_fiber(f);
+            __atomic_fetch_sub(&state.parked_count, 1, __ATOMIC_RELEASE);
+            continue;
+        }
+        platform_sleep(0);
+    }
+}
\ No newline at end of file
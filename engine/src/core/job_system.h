@@ -0,0 +1,70 @@
+#pragma once
+
+#include "defines.h"
+
+// Number of worker threads started by the job system. 0 uses the
+// processor count minus one, leaving a core for the main thread.
+#ifndef JOB_SYSTEM_WORKER_COUNT
+#define JOB_SYSTEM_WORKER_COUNT 0
+#endif
+
+// Jobs each thread's work-stealing deque can hold before submissions
+// overflow into the shared queue. Must be a power of two.
+#define JOB_DEQUE_CAPACITY 4096
+#define JOB_INJECTION_QUEUE_CAPACITY 4096
+
+// Fibers shared by the workers. A job that waits on a counter parks its
+// fiber and the worker carries on in a fresh one. 0 disables fibers and
+// waits run other jobs on the waiting thread's stack instead.
+#ifndef JOB_SYSTEM_FIBER_COUNT
+#define JOB_SYSTEM_FIBER_COUNT 128
+#endif
+
+#ifndef JOB_SYSTEM_FIBER_STACK_SIZE
+#define JOB_SYSTEM_FIBER_STACK_SIZE (64 * 1024)
+#endif
+
+typedef void (*PFN_job_entry)(void* param);
+
+typedef struct job_decl {
+    PFN_job_entry entry;
+    void* param;
+} job_decl;
+
+// Counts the jobs that are still outstanding against it. Zero-initialize
+// before first use; it may live on the stack as long as it is waited on
+// before going out of scope.
+typedef struct job_counter {
+    volatile i32 value;
+    volatile i32 lock;
+    struct job* waiters;
+    struct job_fiber* parked_fibers;
+} job_counter;
+
+typedef struct job_system_config {
+    u32 worker_count;
+    u32 fiber_count;
+    u64 fiber_stack_size;
+} job_system_config;
+
+// Exported so tools/parallel_bench and tools/job_stress can restart it
+// with different counts.
+TAPI b8 job_system_initialize(job_system_config config);
+TAPI void job_system_shutdown();
+
+// Worker threads plus the main thread.
+TAPI u32 job_system_thread_count();
+
+// Queues count jobs. When counter is non-zero it is raised by count and
+// lowered as each job finishes. Safe to call from any thread, including
+// from inside a job.
+TAPI void job_submit(const job_decl* jobs, u32 count, job_counter* counter);
+
+// Like job_submit, but the jobs are held back until dependency reaches
+// zero.
+TAPI void job_submit_after(job_counter* dependency, const job_decl* jobs, u32 count, job_counter* counter);
+
+// Returns once counter reaches zero. Inside a job on a worker the fiber is
+// parked until then; elsewhere queued jobs run on the calling thread.
+TAPI void job_wait(job_counter* counter);
+TAPI b8 job_counter_is_done(job_counter* counter);
@@ -0,0 +1,240 @@
+#pragma once
+
+// Layout of deferred log records and the code to turn them back into text.
+// Shared by the logger's writer thread and the offline decoder in
+// tools/tlog_decode, so it only depends on defines.h and the C library.
+
+#include "defines.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_BINARY_RECORD_SIZE 128
+#define LOG_BINARY_MAX_ARGS 16
+
+// "TLOG" when read as bytes.
+#define LOG_BINARY_FILE_MAGIC 0x474F4C54
+#define LOG_BINARY_FILE_VERSION 2
+
+// How an argument was pulled off the va_list at the call site. long is
+// only 32 bits on Windows, so it is kept apart from long long and its
+// signedness is recorded to widen it correctly.
+typedef enum log_binary_arg_type {
+    LOG_BINARY_ARG_INT,
+    LOG_BINARY_ARG_LONG,
+    LOG_BINARY_ARG_ULONG,
+    LOG_BINARY_ARG_LONG_LONG,
+    LOG_BINARY_ARG_DOUBLE,
+    LOG_BINARY_ARG_STRING,
+    LOG_BINARY_ARG_POINTER
+} log_binary_arg_type;
+
+// Arguments are packed into payload in order: 8 bytes per number or
+// pointer, strings inline including their terminator.
+typedef struct log_binary_record {
+    u32 format_id;
+    u8 level;
+    u8 arg_count;
+    u16 payload_size;
+    f64 time;
+    // Orders records against text lines, see log_writer_drain.
+    u64 sequence;
+    u8 payload[LOG_BINARY_RECORD_SIZE - 24];
+} log_binary_record;
+
+// A binary log file is the magic and version (u32 each) followed by
+// chunks. A format chunk introduces an id before its first record:
+// u8 kind, u32 id, u8 level, u32 line, u16 format length, u16 file
+// length, then both strings without terminators. A record chunk is u8
+// kind followed by a log_binary_record.
+typedef enum log_binary_chunk_kind {
+    LOG_BINARY_CHUNK_FORMAT = 1,
+    LOG_BINARY_CHUNK_RECORD = 2
+} log_binary_chunk_kind;
+
+// Parses one conversion starting right after a '%'. Returns a pointer past
+// it and sets out_spec_length to the characters between '%' and the end.
+// out_type is -1 for "%%" and -2 for conversions that cannot be deferred.
+static const char* log_binary_parse_spec(const char* p, i32* out_type, u32* out_spec_length) {
+    const char* start = p;
+    if(*p == '%') {
+        *out_type = -1;
+        *out_spec_length = 1;
+        return p + 1;
+    }
+
+    while(*p && strchr("-+ #0", *p)) {
+        ++p;
+    }
+    b8 star = FALSE;
+    while(*p && (strchr("0123456789.", *p) || *p == '*')) {
+        star |= *p == '*';
+        ++p;
+    }
+
+    i32 length = 0;
+    if(*p == 'h') {
+        ++p;
+        if(*p == 'h') {
+            ++p;
+        }
+    } else if(*p == 'l') {
+        length = 1;
+        ++p;
+        if(*p == 'l') {
+            length = 2;
+            ++p;
+        }
+    } else if(*p == 'z' || *p == 'j' || *p == 't') {
+        length = 2;
+        ++p;
+    } else if(*p == 'L') {
+        length = 3;
+        ++p;
+    }
+
+    i32 type = -2;
+    switch(*p) {
+        case 'd': case 'i':
+            type = length == 2 ? LOG_BINARY_ARG_LONG_LONG : length == 1 ? LOG_BINARY_ARG_LONG : LOG_BINARY_ARG_INT;
+            break;
+        case 'u': case 'x': case 'X': case 'o':
+            type = length == 2 ? LOG_BINARY_ARG_LONG_LONG : length == 1 ? LOG_BINARY_ARG_ULONG : LOG_BINARY_ARG_INT;
+            break;
+        case 'c':
+            // %lc takes a wint_t.
+            type = length == 0 ? LOG_BINARY_ARG_INT : -2;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            type = length == 3 ? -2 : LOG_BINARY_ARG_DOUBLE;
+            break;
+        case 's':
+            type = length == 0 ? LOG_BINARY_ARG_STRING : -2;
+            break;
+        case 'p':
+            type = LOG_BINARY_ARG_POINTER;
+            break;
+    }
+    if(star || *p == 0) {
+        type = -2;
+    }
+
+    *out_type = type;
+    if(*p) {
+        ++p;
+    }
+    *out_spec_length = (u32)(p - start);
+    return p;
+}
+
+// Fills out_types and returns the argument count, or -1 when the format
+// needs something a record cannot carry (such as '*' widths).
+static i32 log_binary_parse_format(const char* format, u8* out_types) {
+    i32 count = 0;
+    for(const char* p = format; *p;) {
+        if(*p++ != '%') {
+            continue;
+        }
+
+        i32 type;
+        u32 spec_length;
+        p = log_binary_parse_spec(p, &type, &spec_length);
+        if(type == -1) {
+            continue;
+        }
+        if(type < 0 || count == LOG_BINARY_MAX_ARGS) {
+            return -1;
+        }
+        out_types[count++] = (u8)type;
+    }
+    return count;
+}
+
+// Writes the formatted text of record into out, always terminated.
+// Returns the length written.
+static u64 log_binary_format_record(const char* format, const u8* types, const log_binary_record* record, char* out, u64 out_size) {
+    u64 length = 0;
+    u32 offset = 0;
+    u32 arg = 0;
+    out[0] = 0;
+
+    for(const char* p = format; *p && length + 1 < out_size;) {
+        if(*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+
+        const char* spec_start = p++;
+        i32 type;
+        u32 spec_length;
+        p = log_binary_parse_spec(p, &type, &spec_length);
+        if(type == -1) {
+            out[length++] = '%';
+            continue;
+        }
+        if(type < 0 || arg >= record->arg_count) {
+            break;
+        }
+
+        // Rebuild the conversion without its length modifier, then add the
+        // one matching the captured width.
+        char spec[32];
+        u32 spec_size = 0;
+        for(const char* s = spec_start; s < p - 1 && spec_size < sizeof(spec) - 4; ++s) {
+            if(!strchr("hlLzjt", *s)) {
+                spec[spec_size++] = *s;
+            }
+        }
+        if(types[arg] == LOG_BINARY_ARG_LONG || types[arg] == LOG_BINARY_ARG_ULONG) {
+            spec[spec_size++] = 'l';
+        } else if(types[arg] == LOG_BINARY_ARG_LONG_LONG) {
+            spec[spec_size++] = 'l';
+            spec[spec_size++] = 'l';
+        }
+        spec[spec_size++] = p[-1];
+        spec[spec_size] = 0;
+
+        u64 remaining = out_size - length;
+        i32 written = 0;
+        if(types[arg] == LOG_BINARY_ARG_STRING) {
+            const char* value = (const char*)record->payload + offset;
+            written = snprintf(out + length, remaining, spec, value);
+            offset += (u32)strlen(value) + 1;
+        } else {
+            u64 value;
+            memcpy(&value, record->payload + offset, sizeof(u64));
+            offset += sizeof(u64);
+            switch(types[arg]) {
+                case LOG_BINARY_ARG_INT:
+                    written = snprintf(out + length, remaining, spec, (int)value);
+                    break;
+                case LOG_BINARY_ARG_LONG:
+                    written = snprintf(out + length, remaining, spec, (long)(i64)value);
+                    break;
+                case LOG_BINARY_ARG_ULONG:
+                    written = snprintf(out + length, remaining, spec, (unsigned long)value);
+                    break;
+                case LOG_BINARY_ARG_DOUBLE: {
+                    f64 number;
+                    memcpy(&number, &value, sizeof(f64));
+                    written = snprintf(out + length, remaining, spec, number);
+                } break;
+                case LOG_BINARY_ARG_POINTER:
+                    written = snprintf(out + length, remaining, spec, (void*)value);
+                    break;
+                default:
+                    written = snprintf(out + length, remaining, spec, (long long)value);
+                    break;
+            }
+        }
+        ++arg;
+
+        if(written < 0) {
+            break;
+        }
+        length += (u64)written < remaining ? (u64)written : remaining - 1;
+    }
+
+    out[length] = 0;
+    return length;
+}
\ No newline at end of file
@@ -1,52 +1,784 @@
 #include "logger.h"
 #include "asserts.h"
 #include "platform/platform.h"
+#include "core/event.h"
+#include "containers/mpmc_queue.h"
+#include "containers/ring_queue.h"
+#include "core/tmemory.h"
+#include "core/log_binary.inl"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
 
+#define LOG_FILE_PATH_MAX 256
+
+// A formatted line as handed to the writer thread.
+typedef struct log_slot {
+    u64 sequence;
+    u8 level;
+    u16 length;
+    char text[LOG_SLOT_SIZE - 12];
+} log_slot;
+
+// Lines collected in memory and written out in large blocks. Only touched
+// with sink_mutex held.
+typedef struct log_file_sink {
+    platform_file file;
+    char path[LOG_FILE_PATH_MAX];
+    char* buffer;
+    u64 buffer_size;
+    u64 used;
+    u64 flush_threshold;
+    // When the oldest line still in the buffer was added.
+    f64 buffered_since;
+    u64 file_size;
+    u64 max_file_size;
+    u32 max_rotations;
+} log_file_sink;
+
+typedef struct logger_state {
+    mpmc_queue queue;
+    platform_thread writer;
+    platform_semaphore wake;
+    volatile b8 running;
+    volatile i32 writer_sleeping;
+    // Lines queued / written so far, to let log_flush know when it is done.
+    volatile u64 queued_count;
+    volatile u64 written_count;
+    volatile u64 dropped_count;
+    // Shared by lines and deferred records, the writer merges both by it.
+    volatile u64 sequence;
+    log_file_sink file;
+    f64 flush_interval;
+} logger_state;
+
+typedef struct log_binary_format {
+    const char* format;
+    const char* file;
+    i32 line;
+    u8 level;
+    // -1 when the format cannot be deferred, those calls are formatted
+    // as text right away.
+    i8 arg_count;
+    u8 arg_types[LOG_BINARY_MAX_ARGS];
+    // Only touched by the writer.
+    b8 written_to_file;
+} log_binary_format;
+
+// Each thread that logs deferred records gets its own ring, drained by
+// the writer. Rings are only added, so the writer walks the list freely.
+// They come straight from the platform: the engine allocator logs while
+// holding its lock, and a ring may be created from inside a log call.
+typedef struct log_binary_thread {
+    spsc_queue records;
+    struct log_binary_thread* next;
+} log_binary_thread;
+
+typedef struct log_binary_state {
+    log_binary_format* formats;
+    volatile u32 format_count;
+    volatile i32 format_lock;
+    log_binary_thread* threads;
+    // Bumped when shutdown_logging frees the rings, so threads drop the
+    // ring they cached.
+    volatile u32 generation;
+    log_file_sink file;
+} log_binary_state;
+
+static volatile b8 is_async = FALSE;
+static logger_state state;
+// Kept apart from state, call sites can register before initialize_logging.
+static log_binary_state binary;
+static _Thread_local log_binary_thread* thread_records = 0;
+static _Thread_local u32 thread_records_generation = 0;
+// Guards both file sinks, held across their writes and renames. Lines may
+// still be written synchronously while the writer thread is running, see
+// log_output_va. Lives from initialize_logging to shutdown_logging, there
+// are no file sinks outside of that.
+static platform_mutex sink_mutex;
+static b8 sink_mutex_created = FALSE;
+static b8 console_enabled = TRUE;
+static log_level console_level = LOG_LEVEL_TRACE;
+
+static const char* level_strings[6] = {
+    "[FATAL]: ",
+    "[ERROR]: ",
+    "[WARN]:  ",
+    "[INFO]:  ",
+    "[DEBUG]: ",
+    "[TRACE]: ",
+};
+
 void report_assertion_failure(const char* expression, const char* message, const char* file, i32 line) {
     log_output(LOG_LEVEL_FATAL, "Assertion Failure: %s, message: '%s', in file: %s, line: %d\n",
         expression, message, file, line);
 }
 
-b8 initialize_logging() {
-    // TODO: Create log file.
+static void log_sink_lock() {
+    if(sink_mutex_created) {
+        platform_mutex_lock(&sink_mutex);
+    }
+}
+
+static void log_sink_unlock() {
+    if(sink_mutex_created) {
+        platform_mutex_unlock(&sink_mutex);
+    }
+}
+
+// Moves path.1 to path.2 and so on, dropping the oldest, then starts over
+// with an empty file.
+static void log_file_sink_rotate(log_file_sink* sink) {
+    platform_file_close(&sink->file);
+
+    if(sink->max_rotations > 0) {
+        char from[LOG_FILE_PATH_MAX + 16];
+        char to[LOG_FILE_PATH_MAX + 16];
+        snprintf(to, sizeof(to), "%s.%u", sink->path, sink->max_rotations);
+        platform_file_delete(to);
+        for(u32 i = sink->max_rotations - 1; i > 0; --i) {
+            snprintf(from, sizeof(from), "%s.%u", sink->path, i);
+            snprintf(to, sizeof(to), "%s.%u", sink->path, i + 1);
+            platform_file_rename(from, to);
+        }
+        snprintf(to, sizeof(to), "%s.1", sink->path);
+        platform_file_rename(sink->path, to);
+    }
+
+    sink->file_size = 0;
+    if(!platform_file_open(sink->path, FALSE, &sink->file)) {
+        platform_console_write_error("[ERROR]: Could not reopen the log file after rotating it, file logging stopped.\n", LOG_LEVEL_ERROR);
+    }
+}
+
+static void log_file_sink_flush(log_file_sink* sink) {
+    if(sink->used == 0 || !sink->file.internal_data) {
+        return;
+    }
+
+    if(sink->max_file_size && sink->file_size > 0 && sink->file_size + sink->used > sink->max_file_size) {
+        log_file_sink_rotate(sink);
+    }
+    if(sink->file.internal_data) {
+        if(platform_file_write(&sink->file, sink->buffer, sink->used)) {
+            sink->file_size += sink->used;
+        } else {
+            platform_file_close(&sink->file);
+            platform_console_write_error("[ERROR]: Writing the log file failed, file logging stopped.\n", LOG_LEVEL_ERROR);
+        }
+    }
+    sink->used = 0;
+}
+
+static void log_file_sink_write(log_file_sink* sink, const void* data, u64 size) {
+    const u8* bytes = data;
+    while(size > 0 && sink->file.internal_data) {
+        if(sink->used == 0) {
+            sink->buffered_since = platform_get_absolute_time();
+        }
+        u64 chunk = sink->buffer_size - sink->used;
+        if(chunk > size) {
+            chunk = size;
+        }
+        memcpy(sink->buffer + sink->used, bytes, chunk);
+        sink->used += chunk;
+        bytes += chunk;
+        size -= chunk;
+
+        if(sink->used >= sink->flush_threshold) {
+            log_file_sink_flush(sink);
+        }
+    }
+}
+
+static void log_file_sink_close(log_file_sink* sink) {
+    log_file_sink_flush(sink);
+    platform_file_close(&sink->file);
+    if(sink->buffer) {
+        platform_free(sink->buffer, 0);
+    }
+    memset(sink, 0, sizeof(log_file_sink));
+}
+
+static b8 log_file_sink_open(log_file_sink* sink, const char* path, u64 buffer_size, u64 flush_threshold, u64 max_file_size, u32 max_rotations) {
+    memset(sink, 0, sizeof(log_file_sink));
+    u64 length = strlen(path);
+    if(length + 1 > sizeof(sink->path) || buffer_size == 0) {
+        return FALSE;
+    }
+    memcpy(sink->path, path, length + 1);
+
+    if(!platform_file_open(path, TRUE, &sink->file)) {
+        return FALSE;
+    }
+    sink->buffer = platform_allocate(buffer_size, 0);
+    sink->buffer_size = buffer_size;
+    sink->flush_threshold = flush_threshold && flush_threshold < buffer_size ? flush_threshold : buffer_size;
+    sink->max_file_size = max_file_size;
+    sink->max_rotations = max_rotations;
+
+    // The previous run's log becomes path.1 rather than being overwritten.
+    if(platform_file_size(&sink->file) > 0) {
+        log_file_sink_rotate(sink);
+        if(!sink->file.internal_data) {
+            log_file_sink_close(sink);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Flushes sinks whose oldest line has waited the flush interval. Returns
+// how long the writer may sleep in ms, 0 when nothing is waiting.
+static u32 log_sinks_flush_due() {
+    f64 now = platform_get_absolute_time();
+    f64 wait = -1.0;
+    log_file_sink* sinks[2] = {&state.file, &binary.file};
+
+    log_sink_lock();
+    for(u32 i = 0; i < 2; ++i) {
+        if(sinks[i]->used == 0) {
+            continue;
+        }
+        f64 remaining = sinks[i]->buffered_since + state.flush_interval - now;
+        if(remaining <= 0.0) {
+            log_file_sink_flush(sinks[i]);
+        } else if(wait < 0.0 || remaining < wait) {
+            wait = remaining;
+        }
+    }
+    log_sink_unlock();
+
+    if(wait < 0.0) {
+        return 0;
+    }
+    u32 ms = (u32)(wait * 1000.0) + 1;
+    return ms;
+}
+
+static void log_write(log_level level, const char* text) {
+    if(console_enabled && level <= console_level) {
+        b8 is_error = level < LOG_LEVEL_WARNING;
+        if(is_error) {
+            platform_console_write_error(text, level);
+        } else {
+            platform_console_write(text, level);
+        }
+    }
+
+    log_sink_lock();
+    if(state.file.file.internal_data) {
+        log_file_sink_write(&state.file, text, strlen(text));
+    }
+    if(level == LOG_LEVEL_FATAL) {
+        log_file_sink_flush(&state.file);
+        log_file_sink_flush(&binary.file);
+    }
+    log_sink_unlock();
+}
+
+static void log_wake_writer() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&state.writer_sleeping, __ATOMIC_RELAXED)) {
+        platform_semaphore_signal(&state.wake, 1);
+    }
+}
+
+static void log_binary_lock() {
+    while(__atomic_exchange_n(&binary.format_lock, 1, __ATOMIC_ACQUIRE)) {
+        while(__atomic_load_n(&binary.format_lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void log_binary_unlock() {
+    __atomic_store_n(&binary.format_lock, 0, __ATOMIC_RELEASE);
+}
+
+static void log_binary_write_format(u32 id, log_binary_format* format) {
+    u8 kind = LOG_BINARY_CHUNK_FORMAT;
+    u16 format_length = (u16)strlen(format->format);
+    u16 file_length = (u16)strlen(format->file);
+    u32 line = (u32)format->line;
+    log_file_sink_write(&binary.file, &kind, sizeof(kind));
+    log_file_sink_write(&binary.file, &id, sizeof(id));
+    log_file_sink_write(&binary.file, &format->level, sizeof(format->level));
+    log_file_sink_write(&binary.file, &line, sizeof(line));
+    log_file_sink_write(&binary.file, &format_length, sizeof(format_length));
+    log_file_sink_write(&binary.file, &file_length, sizeof(file_length));
+    log_file_sink_write(&binary.file, format->format, format_length);
+    log_file_sink_write(&binary.file, format->file, file_length);
+    format->written_to_file = TRUE;
+}
+
+static void log_binary_process(const log_binary_record* record) {
+    log_binary_format* format = &binary.formats[record->format_id - 1];
+    log_sink_lock();
+    if(binary.file.file.internal_data) {
+        if(!format->written_to_file) {
+            log_binary_write_format(record->format_id, format);
+        }
+        u8 kind = LOG_BINARY_CHUNK_RECORD;
+        log_file_sink_write(&binary.file, &kind, sizeof(kind));
+        log_file_sink_write(&binary.file, record, sizeof(log_binary_record));
+        log_sink_unlock();
+        return;
+    }
+    log_sink_unlock();
+
+    char text[LOG_SLOT_SIZE];
+    u64 prefix_length = strlen(level_strings[record->level]);
+    memcpy(text, level_strings[record->level], prefix_length);
+    u64 length = prefix_length + log_binary_format_record(format->format, format->arg_types, record,
+                                                          text + prefix_length, sizeof(text) - prefix_length - 1);
+    text[length] = '\n';
+    text[length + 1] = 0;
+    log_write(record->level, text);
+}
+
+// Writes queued lines and deferred records in sequence order. A thread's
+// earlier entries are always visible once a later one has been seen, so
+// records older than the line at hand go first, and a record is only
+// written after checking that no older line came in meanwhile. Returns
+// TRUE if anything was written.
+static b8 log_writer_drain() {
+    b8 any = FALSE;
+    log_slot slot;
+    log_binary_record record;
+    for(;;) {
+        b8 has_slot = mpmc_queue_try_pop(&state.queue, &slot);
+        b8 wrote_records = FALSE;
+        log_binary_thread* thread = __atomic_load_n(&binary.threads, __ATOMIC_ACQUIRE);
+        for(; thread; thread = thread->next) {
+            while(spsc_queue_peek(&thread->records, &record)) {
+                if(!has_slot) {
+                    has_slot = mpmc_queue_try_pop(&state.queue, &slot);
+                }
+                if(has_slot && slot.sequence < record.sequence) {
+                    break;
+                }
+                spsc_queue_try_pop(&thread->records, &record);
+                log_binary_process(&record);
+                __atomic_fetch_add(&state.written_count, 1, __ATOMIC_RELEASE);
+                wrote_records = TRUE;
+            }
+        }
+
+        if(has_slot) {
+            log_write(slot.level, slot.text);
+            __atomic_fetch_add(&state.written_count, 1, __ATOMIC_RELEASE);
+        } else if(!wrote_records) {
+            return any;
+        }
+        any = TRUE;
+    }
+}
+
+static u32 log_writer_main(void* param) {
+    u64 reported_drops = 0;
+    for(;;) {
+        log_writer_drain();
+
+        u64 dropped = __atomic_load_n(&state.dropped_count, __ATOMIC_RELAXED);
+        if(dropped != reported_drops) {
+            char text[128];
+            snprintf(text, sizeof(text), "%sLogger queue was full, %llu messages dropped.\n",
+                level_strings[LOG_LEVEL_WARNING], dropped - reported_drops);
+            log_write(LOG_LEVEL_WARNING, text);
+            reported_drops = dropped;
+        }
+
+        if(!__atomic_load_n(&state.running, __ATOMIC_ACQUIRE)) {
+            // Anything queued before running was cleared has been written.
+            if(__atomic_load_n(&state.written_count, __ATOMIC_ACQUIRE) == __atomic_load_n(&state.queued_count, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            continue;
+        }
+
+        // Pairs with log_wake_writer: either the producer sees the flag or
+        // the queue check below sees its line.
+        __atomic_store_n(&state.writer_sleeping, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if(log_writer_drain()) {
+            __atomic_store_n(&state.writer_sleeping, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+        if(__atomic_load_n(&state.running, __ATOMIC_ACQUIRE)) {
+            // Buffered lines are written once they are old enough, without
+            // waiting for the next one to arrive.
+            u32 timeout_ms = log_sinks_flush_due();
+            if(timeout_ms) {
+                platform_semaphore_wait_timeout(&state.wake, timeout_ms);
+            } else {
+                platform_semaphore_wait(&state.wake);
+            }
+        }
+        __atomic_store_n(&state.writer_sleeping, 0, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+static b8 log_binary_open_file(const char* path) {
+    // Only rotated at open, a decoder needs the format chunks from the
+    // start of the file.
+    if(!log_file_sink_open(&binary.file, path, LOG_FILE_BUFFER_SIZE, LOG_FILE_FLUSH_THRESHOLD, 0, LOG_FILE_MAX_ROTATIONS)) {
+        return FALSE;
+    }
+
+    u32 header[2] = {LOG_BINARY_FILE_MAGIC, LOG_BINARY_FILE_VERSION};
+    log_file_sink_write(&binary.file, header, sizeof(header));
+    // A file from an earlier run of the logger got the formats, this one
+    // has not yet.
+    u32 format_count = __atomic_load_n(&binary.format_count, __ATOMIC_ACQUIRE);
+    for(u32 i = 0; i < format_count; ++i) {
+        binary.formats[i].written_to_file = FALSE;
+    }
+    return TRUE;
+}
+
+b8 initialize_logging(logger_config config) {
+    if(is_async) {
+        return FALSE;
+    }
+
+    memset(&state, 0, sizeof(state));
+    console_enabled = config.console_enabled;
+    console_level = config.console_level;
+    state.flush_interval = config.flush_interval_ms * 0.001;
+    if(!sink_mutex_created) {
+        if(!platform_mutex_create(&sink_mutex)) {
+            return FALSE;
+        }
+        sink_mutex_created = TRUE;
+    }
+    if(config.file_path) {
+        log_sink_lock();
+        b8 opened = log_file_sink_open(&state.file, config.file_path, config.file_buffer_size, config.flush_threshold,
+                                       config.max_file_size, config.max_rotations);
+        log_sink_unlock();
+        if(!opened) {
+            TERROR("Unable to open log file '%s', logging to the console only.", config.file_path);
+            console_enabled = TRUE;
+        }
+    }
+    if(config.binary_file_path) {
+        log_sink_lock();
+        b8 opened = log_binary_open_file(config.binary_file_path);
+        log_sink_unlock();
+        if(!opened) {
+            TERROR("Unable to open binary log file '%s', deferred lines are written as text.", config.binary_file_path);
+        }
+    }
+
+    if(!mpmc_queue_create(sizeof(log_slot), LOG_SLOT_COUNT, &state.queue)) {
+        return FALSE;
+    }
+    if(!platform_semaphore_create(0, 0x7FFFFFFF, &state.wake)) {
+        mpmc_queue_destroy(&state.queue);
+        return FALSE;
+    }
+
+    state.running = TRUE;
+    if(!platform_thread_create(log_writer_main, 0, &state.writer)) {
+        platform_semaphore_destroy(&state.wake);
+        mpmc_queue_destroy(&state.queue);
+        return FALSE;
+    }
+
+    __atomic_store_n(&is_async, TRUE, __ATOMIC_RELEASE);
     return TRUE;
 }
 
+static void log_binary_thread_destroy(log_binary_thread* thread) {
+    void* memory = thread->records.memory;
+    spsc_queue_destroy(&thread->records);
+    platform_free(memory, SPSC_QUEUE_CACHE_LINE);
+    platform_free(thread, SPSC_QUEUE_CACHE_LINE);
+}
+
 void shutdown_logging() {
-    // TODO: Cleanup logging queued entries.
+    if(!is_async) {
+        return;
+    }
+
+    // From here on log_output writes synchronously again, the writer drains
+    // what was queued before exiting.
+    __atomic_store_n(&is_async, FALSE, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&state.running, FALSE, __ATOMIC_RELEASE);
+    platform_semaphore_signal(&state.wake, 1);
+    platform_thread_join(&state.writer);
+
+    platform_semaphore_destroy(&state.wake);
+    mpmc_queue_destroy(&state.queue);
+
+    log_sink_lock();
+    log_file_sink_close(&state.file);
+    log_file_sink_close(&binary.file);
+    console_enabled = TRUE;
+    console_level = LOG_LEVEL_TRACE;
+    log_sink_unlock();
+    sink_mutex_created = FALSE;
+    platform_mutex_destroy(&sink_mutex);
+
+    // Rings of other threads are gone too. Their next deferred call finds
+    // the logger stopped and writes text, or after a restart sees the new
+    // generation and makes a new ring.
+    while(binary.threads) {
+        log_binary_thread* next = binary.threads->next;
+        log_binary_thread_destroy(binary.threads);
+        binary.threads = next;
+    }
+    __atomic_add_fetch(&binary.generation, 1, __ATOMIC_RELEASE);
+}
+
+static void log_wait_for_writer() {
+    if(!is_async) {
+        return;
+    }
+
+    u64 target = __atomic_load_n(&state.queued_count, __ATOMIC_ACQUIRE);
+    log_wake_writer();
+    while(__atomic_load_n(&state.written_count, __ATOMIC_ACQUIRE) < target) {
+        platform_sleep(0);
+    }
 }
 
+void log_flush() {
+    log_wait_for_writer();
 
-void log_output(log_level level, const char *message, ...) {
-    const char* level_strings[6] = {
-        "[FATAL]: ",
-        "[ERROR]: ",
-        "[WARN]:  ",
-        "[INFO]:  ",
-        "[DEBUG]: ",
-        "[TRACE]: ",
-    };
-    b8 is_error = level < LOG_LEVEL_WARNING;
-
-    #define msg_length 32000
-    char out_message[msg_length];
-    memset(out_message, 0, sizeof(out_message));
-
-    __builtin_va_list arg_ptr;
-    va_start(arg_ptr, message);
-    vsnprintf(out_message, msg_length, message, arg_ptr);
-    va_end(arg_ptr);
-
-    char out_message2[msg_length];
-    sprintf(out_message2, "%s%s\n", level_strings[level], out_message);
-
-    if(is_error) {
-        platform_console_write_error(out_message2, level);
+    log_sink_lock();
+    log_file_sink_flush(&state.file);
+    log_file_sink_flush(&binary.file);
+    log_sink_unlock();
+}
+
+u64 log_dropped_count() {
+    return __atomic_load_n(&state.dropped_count, __ATOMIC_RELAXED);
+}
+
+static b8 log_enqueue(const log_slot* slot) {
+    while(!mpmc_queue_try_push(&state.queue, slot)) {
+#if LOG_BLOCK_WHEN_FULL
+        log_wake_writer();
+        platform_sleep(0);
+#else
+        __atomic_fetch_add(&state.dropped_count, 1, __ATOMIC_RELAXED);
+        return FALSE;
+#endif
+    }
+
+    __atomic_fetch_add(&state.queued_count, 1, __ATOMIC_RELEASE);
+    log_wake_writer();
+    return TRUE;
+}
+
+static void log_output_va(log_level level, const char* message, va_list args) {
+    log_slot slot;
+    slot.level = level;
+
+    u64 prefix_length = strlen(level_strings[level]);
+    memcpy(slot.text, level_strings[level], prefix_length);
+
+    va_list format_args;
+    va_copy(format_args, args);
+    // Leaves room for the newline.
+    i32 written = vsnprintf(slot.text + prefix_length, sizeof(slot.text) - prefix_length - 1, message, format_args);
+    va_end(format_args);
+
+    if(written < 0) {
+        return;
+    }
+
+    if(prefix_length + written + 2 > sizeof(slot.text)) {
+        // Too long for a slot. Wait for the writer so ordering holds, then
+        // format and write it on this thread.
+        log_wait_for_writer();
+        u64 size = prefix_length + written + 2;
+        char* text = platform_allocate(size, 0);
+        memcpy(text, level_strings[level], prefix_length);
+        vsnprintf(text + prefix_length, size - prefix_length - 1, message, args);
+        text[size - 2] = '\n';
+        text[size - 1] = 0;
+        log_write(level, text);
+        platform_free(text, 0);
     } else {
-        platform_console_write(out_message2, level);
+        slot.length = (u16)(prefix_length + written + 1);
+        slot.text[slot.length - 1] = '\n';
+        slot.text[slot.length] = 0;
+
+        slot.sequence = __atomic_fetch_add(&state.sequence, 1, __ATOMIC_RELAXED);
+
+        // Fatal lines go out immediately, the process may not survive long
+        // enough for the writer to get to them.
+        if(level == LOG_LEVEL_FATAL || !__atomic_load_n(&is_async, __ATOMIC_ACQUIRE)) {
+            log_wait_for_writer();
+            log_write(level, slot.text);
+        } else {
+            log_enqueue(&slot);
+        }
+    }
+}
+
+void log_output(log_level level, const char *message, ...) {
+    va_list args;
+    va_start(args, message);
+    log_output_va(level, message, args);
+    va_end(args);
+
+#if TEVENT_INSTRUMENTATION
+    // Dumping logs at ERROR, so this cannot recurse.
+    if(level == LOG_LEVEL_FATAL) {
+        event_dump_trace();
+    }
+#endif
+}
+
+u32 log_binary_register(log_level level, const char* format, const char* file, i32 line) {
+    log_binary_lock();
+    if(!binary.formats) {
+        binary.formats = platform_allocate(sizeof(log_binary_format) * LOG_BINARY_MAX_FORMATS, 0);
+        memset(binary.formats, 0, sizeof(log_binary_format) * LOG_BINARY_MAX_FORMATS);
+    }
+
+    u32 id = 0;
+    if(binary.format_count < LOG_BINARY_MAX_FORMATS) {
+        log_binary_format* entry = &binary.formats[binary.format_count];
+        entry->format = format;
+        entry->file = file;
+        entry->line = line;
+        entry->level = (u8)level;
+        entry->arg_count = (i8)log_binary_parse_format(format, entry->arg_types);
+        id = __atomic_add_fetch(&binary.format_count, 1, __ATOMIC_RELEASE);
     }
+    log_binary_unlock();
+    // 0 keeps the call site formatting as text.
+    return id;
+}
+
+static log_binary_thread* log_binary_thread_records() {
+    u32 generation = __atomic_load_n(&binary.generation, __ATOMIC_ACQUIRE);
+    if(thread_records && thread_records_generation == generation) {
+        return thread_records;
+    }
+    thread_records = 0;
+
+    log_binary_thread* thread = platform_allocate(sizeof(log_binary_thread), SPSC_QUEUE_CACHE_LINE);
+    void* memory = platform_allocate(sizeof(log_binary_record) * LOG_BINARY_THREAD_RECORDS, SPSC_QUEUE_CACHE_LINE);
+    if(!thread || !memory || !spsc_queue_create(sizeof(log_binary_record), LOG_BINARY_THREAD_RECORDS, memory, &thread->records)) {
+        if(thread) {
+            platform_free(thread, SPSC_QUEUE_CACHE_LINE);
+        }
+        if(memory) {
+            platform_free(memory, SPSC_QUEUE_CACHE_LINE);
+        }
+        return 0;
+    }
+
+    log_binary_lock();
+    thread->next = binary.threads;
+    __atomic_store_n(&binary.threads, thread, __ATOMIC_RELEASE);
+    log_binary_unlock();
+
+    thread_records = thread;
+    thread_records_generation = generation;
+    return thread;
+}
+
+// Packs the arguments described by format into record. Returns FALSE if
+// they do not fit, the caller then formats the line as text instead.
+static b8 log_binary_capture(const log_binary_format* format, log_binary_record* record, va_list args) {
+    u32 offset = 0;
+    for(i32 i = 0; i < format->arg_count; ++i) {
+        u64 value = 0;
+        switch(format->arg_types[i]) {
+            case LOG_BINARY_ARG_INT:
+                value = (u64)(i64)va_arg(args, int);
+                break;
+            case LOG_BINARY_ARG_LONG:
+                value = (u64)(i64)va_arg(args, long);
+                break;
+            case LOG_BINARY_ARG_ULONG:
+                value = (u64)va_arg(args, unsigned long);
+                break;
+            case LOG_BINARY_ARG_LONG_LONG:
+                value = (u64)va_arg(args, long long);
+                break;
+            case LOG_BINARY_ARG_DOUBLE: {
+                f64 number = va_arg(args, double);
+                memcpy(&value, &number, sizeof(u64));
+            } break;
+            case LOG_BINARY_ARG_POINTER:
+                value = (u64)va_arg(args, void*);
+                break;
+            case LOG_BINARY_ARG_STRING: {
+                const char* string = va_arg(args, const char*);
+                if(!string) {
+                    string = "(null)";
+                }
+                u64 length = strlen(string) + 1;
+                if(offset + length > sizeof(record->payload)) {
+                    return FALSE;
+                }
+                memcpy(record->payload + offset, string, length);
+                offset += (u32)length;
+                continue;
+            }
+        }
+
+        if(offset + sizeof(u64) > sizeof(record->payload)) {
+            return FALSE;
+        }
+        memcpy(record->payload + offset, &value, sizeof(u64));
+        offset += sizeof(u64);
+    }
+
+    record->arg_count = (u8)format->arg_count;
+    record->payload_size = (u16)offset;
+    return TRUE;
+}
+
+void log_binary_output(log_level level, u32 format_id, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    log_binary_thread* thread = 0;
+    if(format_id != 0 && binary.formats[format_id - 1].arg_count >= 0 && __atomic_load_n(&is_async, __ATOMIC_ACQUIRE)) {
+        thread = log_binary_thread_records();
+    }
+
+    if(thread) {
+        log_binary_record record;
+        record.format_id = format_id;
+        record.level = (u8)level;
+        record.time = platform_get_absolute_time();
+        record.sequence = __atomic_fetch_add(&state.sequence, 1, __ATOMIC_RELAXED);
+
+        va_list capture_args;
+        va_copy(capture_args, args);
+        b8 captured = log_binary_capture(&binary.formats[format_id - 1], &record, capture_args);
+        va_end(capture_args);
+
+        if(captured) {
+            while(!spsc_queue_try_push(&thread->records, &record)) {
+#if LOG_BLOCK_WHEN_FULL
+                log_wake_writer();
+                platform_sleep(0);
+#else
+                __atomic_fetch_add(&state.dropped_count, 1, __ATOMIC_RELAXED);
+                va_end(args);
+                return;
+#endif
+            }
+
+            __atomic_fetch_add(&state.queued_count, 1, __ATOMIC_RELEASE);
+            log_wake_writer();
+            va_end(args);
+            return;
+        }
+    }
+
+    log_output_va(level, format, args);
+    va_end(args);
 }
\ No newline at end of file
@@ -12,6 +12,52 @@
 #define LOG_TRACE_ENABLED 0
 #endif
 
+// Lines are formatted on the calling thread into fixed-size slots and
+// written by a background thread. Lines longer than a slot are written
+// synchronously after a flush.
+#define LOG_SLOT_SIZE 512
+#define LOG_SLOT_COUNT 1024
+
+// When the queue is full, 1 makes callers wait for the writer and 0 drops
+// the line and counts it.
+#ifndef LOG_BLOCK_WHEN_FULL
+#define LOG_BLOCK_WHEN_FULL 0
+#endif
+
+// Set to 1 to defer formatting of WARN, INFO, DEBUG and TRACE lines. The
+// call site then only records a format id and the raw arguments in a
+// per-thread ring, and the writer thread formats them or stores them in a
+// binary file for tools/tlog_decode. Formats must be string literals.
+#ifndef TLOG_BINARY
+#define TLOG_BINARY 0
+#endif
+
+// Where the writer stores deferred records. 0 formats them as text like
+// every other line.
+#ifndef LOG_BINARY_FILE_PATH
+#define LOG_BINARY_FILE_PATH 0
+#endif
+
+// Records each thread can have in flight before the drop/block policy
+// applies, a power of two. Format ids available to the whole program.
+#define LOG_BINARY_THREAD_RECORDS 1024
+#define LOG_BINARY_MAX_FORMATS 4096
+
+// Defaults for the file sink. The writer thread collects lines in a buffer
+// and writes it out when it passes the threshold, when the interval has
+// elapsed or when it runs out of lines. Once the file would grow past the
+// max size it is renamed to path.1 (path.1 to path.2 and so on, keeping
+// LOG_FILE_MAX_ROTATIONS) and a new one is started. A log left by the
+// previous run is rotated the same way at startup.
+#ifndef LOG_FILE_PATH
+#define LOG_FILE_PATH "console.log"
+#endif
+#define LOG_FILE_BUFFER_SIZE (256 * 1024)
+#define LOG_FILE_FLUSH_THRESHOLD (64 * 1024)
+#define LOG_FILE_FLUSH_INTERVAL_MS 1000
+#define LOG_FILE_MAX_SIZE (16 * 1024 * 1024)
+#define LOG_FILE_MAX_ROTATIONS 4
+
 typedef enum log_level {
     LOG_LEVEL_FATAL = 0,
     LOG_LEVEL_ERROR = 1,
@@ -21,11 +67,55 @@ typedef enum log_level {
     LOG_LEVEL_TRACE = 5
 } log_level;
 
-b8 initialize_logging();
+typedef struct logger_config {
+    // 0 disables the file sink.
+    const char* file_path;
+    // 0 writes deferred records as text, see LOG_BINARY_FILE_PATH.
+    const char* binary_file_path;
+    u64 file_buffer_size;
+    u64 flush_threshold;
+    u32 flush_interval_ms;
+    // 0 lets the file grow without rotating.
+    u64 max_file_size;
+    u32 max_rotations;
+    b8 console_enabled;
+    // Lines above this level are left out of the console.
+    log_level console_level;
+} logger_config;
+
+// Until initialize_logging and after shutdown_logging, lines are written
+// synchronously and to the console only. Shut down once no other thread
+// logs any more.
+b8 initialize_logging(logger_config config);
 void shutdown_logging();
 
+// Blocks until every line queued so far has been written and the file
+// buffers are handed to the OS.
+TAPI void log_flush();
+TAPI u64 log_dropped_count();
+
 TAPI void log_output(log_level level, const char* message, ...);
 
+// Used by the deferred macros, register once per call site and capture.
+TAPI u32 log_binary_register(log_level level, const char* format, const char* file, i32 line);
+TAPI void log_binary_output(log_level level, u32 format_id, const char* format, ...);
+
+#if TLOG_BINARY == 1
+#define TLOG_DEFERRED(level, message, ...)                                                        \
+    do {                                                                                          \
+        static u32 tlog_format_id = 0;                                                            \
+        u32 tlog_id = __atomic_load_n(&tlog_format_id, __ATOMIC_ACQUIRE);                         \
+        if(!tlog_id) {                                                                            \
+            tlog_id = log_binary_register(level, "" message "", __FILE__, __LINE__);              \
+            __atomic_store_n(&tlog_format_id, tlog_id, __ATOMIC_RELEASE);                         \
+        }                                                                                         \
+        log_binary_output(level, tlog_id, message, ##__VA_ARGS__);                                \
+    } while(0)
+#define TLOG_OUTPUT(level, message, ...) TLOG_DEFERRED(level, message, ##__VA_ARGS__)
+#else
+#define TLOG_OUTPUT(level, message, ...) log_output(level, message, ##__VA_ARGS__)
+#endif
+
 #define TFATAL(message, ...) log_output(LOG_LEVEL_FATAL, message, ##__VA_ARGS__);
 
 #ifndef TERROR
@@ -33,25 +123,25 @@ TAPI void log_output(log_level level, const char* message, ...);
 #endif
 
 #if LOG_WARN_ENABLED == 1
-#define TWARN(message, ...) log_output(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
+#define TWARN(message, ...) TLOG_OUTPUT(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
 #else
 #define TWARN(message, ...)
 #endif
 
 #if LOG_INFO_ENABLED == 1
-#define TINFO(message, ...) log_output(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
+#define TINFO(message, ...) TLOG_OUTPUT(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
 #else
 #define TINFO(message, ...)
 #endif
 
 #if LOG_DEBUG_ENABLED == 1
-#define TDEBUG(message, ...) log_output(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+#define TDEBUG(message, ...) TLOG_OUTPUT(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
 #else
 #define TDEBUG(message, ...)
 #endif
 
 #if LOG_TRACE_ENABLED == 1
-#define TTRACE(message, ...) log_output(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+#define TTRACE(message, ...) TLOG_OUTPUT(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
 #else
 #define TTRACE(message, ...)
 #endif
\ No newline at end of file
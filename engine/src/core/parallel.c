@@ -0,0 +1,149 @@
+#include "core/parallel.h"
+
+#include "core/job_system.h"
+#include "core/logger.h"
+#include "core/tmemory.h"
+
+// Pieces per thread when the grain size is picked automatically, so
+// uneven pieces still balance out through stealing.
+#define PARALLEL_PIECES_PER_THREAD 8
+// Each split halves the range, so this covers any 32-bit count at a grain
+// of one. Longer ranges are left for the remaining piece.
+#define PARALLEL_MAX_SPLITS 32
+
+typedef struct parallel_context {
+    u64 grain_size;
+    PFN_parallel_for for_fn;
+    PFN_parallel_reduce_range range_fn;
+    PFN_parallel_reduce_combine combine_fn;
+    u64 result_size;
+    const void* identity;
+    void* user_data;
+} parallel_context;
+
+typedef struct parallel_range {
+    u64 begin;
+    u64 end;
+    const parallel_context* context;
+    u8 result[PARALLEL_REDUCE_MAX_RESULT_SIZE];
+} parallel_range;
+
+// Hands the upper half to the job system until the rest fits the grain
+// size, runs that piece here, then waits for the halves. The split ranges
+// live on this stack, which is safe because the job waits before returning.
+static void parallel_run_range(void* param) {
+    parallel_range* range = (parallel_range*)param;
+    const parallel_context* context = range->context;
+
+    parallel_range splits[PARALLEL_MAX_SPLITS];
+    u32 split_count = 0;
+    job_counter counter = {};
+
+    u64 begin = range->begin;
+    u64 end = range->end;
+    while(end - begin > context->grain_size && split_count < PARALLEL_MAX_SPLITS) {
+        u64 middle = begin + (end - begin) / 2;
+        parallel_range* upper = &splits[split_count++];
+        upper->begin = middle;
+        upper->end = end;
+        upper->context = context;
+        if(context->range_fn) {
+            tcopy_memory(upper->result, context->identity, context->result_size);
+        }
+
+        job_decl decl = {parallel_run_range, upper};
+        job_submit(&decl, 1, &counter);
+        end = middle;
+    }
+
+    if(context->range_fn) {
+        context->range_fn(begin, end, range->result, context->user_data);
+    } else {
+        context->for_fn(begin, end, context->user_data);
+    }
+
+    job_wait(&counter);
+
+    // The last split is the one right after this piece.
+    if(context->range_fn) {
+        for(u32 i = split_count; i > 0; --i) {
+            context->combine_fn(range->result, splits[i - 1].result, context->user_data);
+        }
+    }
+}
+
+static u64 parallel_grain_size(u64 count, u64 grain_size) {
+    if(grain_size > 0) {
+        return grain_size;
+    }
+
+    u64 pieces = (u64)job_system_thread_count() * PARALLEL_PIECES_PER_THREAD;
+    grain_size = count / pieces;
+    return grain_size > 0 ? grain_size : 1;
+}
+
+void parallel_for(u64 count, u64 grain_size, PFN_parallel_for fn, void* user_data) {
+    if(count == 0) {
+        return;
+    }
+
+    grain_size = parallel_grain_size(count, grain_size);
+    if(count <= grain_size || job_system_thread_count() == 1) {
+        fn(0, count, user_data);
+        return;
+    }
+
+    parallel_context context = {};
+    context.grain_size = grain_size;
+    context.for_fn = fn;
+    context.user_data = user_data;
+
+    parallel_range range = {};
+    range.end = count;
+    range.context = &context;
+    parallel_run_range(&range);
+}
+
+b8 parallel_reduce(
+    u64 count,
+    u64 grain_size,
+    u64 result_size,
+    const void* identity,
+    PFN_parallel_reduce_range range_fn,
+    PFN_parallel_reduce_combine combine_fn,
+    void* user_data,
+    void* out_result)
+{
+    if(result_size == 0 || result_size > PARALLEL_REDUCE_MAX_RESULT_SIZE) {
+        TERROR("parallel_reduce result size must be between 1 and %u bytes.", PARALLEL_REDUCE_MAX_RESULT_SIZE);
+        return FALSE;
+    }
+
+    tcopy_memory(out_result, identity, result_size);
+    if(count == 0) {
+        return TRUE;
+    }
+
+    grain_size = parallel_grain_size(count, grain_size);
+    if(count <= grain_size || job_system_thread_count() == 1) {
+        range_fn(0, count, out_result, user_data);
+        return TRUE;
+    }
+
+    parallel_context context = {};
+    context.grain_size = grain_size;
+    context.range_fn = range_fn;
+    context.combine_fn = combine_fn;
+    context.result_size = result_size;
+    context.identity = identity;
+    context.user_data = user_data;
+
+    parallel_range range = {};
+    range.end = count;
+    range.context = &context;
+    tcopy_memory(range.result, identity, result_size);
+    parallel_run_range(&range);
+
+    tcopy_memory(out_result, range.result, result_size);
+    return TRUE;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "defines.h"
+
+// Largest per-range result parallel_reduce can carry.
+#define PARALLEL_REDUCE_MAX_RESULT_SIZE 32
+
+// Processes indices [begin, end).
+typedef void (*PFN_parallel_for)(u64 begin, u64 end, void* user_data);
+
+// Folds indices [begin, end) into result, which starts out as the identity.
+typedef void (*PFN_parallel_reduce_range)(u64 begin, u64 end, void* result, void* user_data);
+// Folds value into accumulator. Ranges are combined in index order, so the
+// operation only has to be associative.
+typedef void (*PFN_parallel_reduce_combine)(void* accumulator, const void* value, void* user_data);
+
+// Splits [0, count) in halves across the job system until pieces are no
+// larger than grain_size, and returns once every piece has run. A
+// grain_size of 0 picks one from the count and the number of threads.
+// Small counts, or no job system, run serially on the calling thread.
+TAPI void parallel_for(u64 count, u64 grain_size, PFN_parallel_for fn, void* user_data);
+
+// Same splitting as parallel_for. identity and out_result are
+// result_size bytes.
+TAPI b8 parallel_reduce(
+    u64 count,
+    u64 grain_size,
+    u64 result_size,
+    const void* identity,
+    PFN_parallel_reduce_range range_fn,
+    PFN_parallel_reduce_combine combine_fn,
+    void* user_data,
+    void* out_result);
@@ -2,14 +2,22 @@
 
 #include "core/logger.h"
 #include "core/tstring.h"
+#include "memory/dynamic_allocator.h"
+#include "memory/linear_allocator.h"
 #include "platform/platform.h"
 
 #include <stdio.h>
+#include <stdarg.h>
 
-struct memory_stats {
-    u64 total_allocated;
-    u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];
-};
+// The tracking wrappers would rename the definitions below.
+#if TMEMORY_TRACKING == 1
+#undef tallocate
+#undef tallocate_aligned
+#undef tallocate_uninitialized
+#undef treallocate
+#undef tfree
+#undef tfree_aligned
+#endif
 
 static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "UNKNOWN    ",
@@ -28,43 +36,404 @@ static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "TRANSFORM  ",
     "ENTITY     ",
     "ENTITY_NODE",
-    "SCENE      "
+    "SCENE      ",
+    "LINEAR_ALLC",
+    "EVENT      "
 };
 
-static struct memory_stats stats;
+// Updated with relaxed atomics so allocations from any thread are counted
+// exactly without a lock. Readers only need a consistent value per counter.
+static memory_stats stats;
+static memory_system_config config;
+static b8 use_heap = FALSE;
+static void* heap_block = 0;
+static dynamic_allocator heap;
+static volatile i32 heap_lock = 0;
+static linear_allocator frame_allocator;
+
+static void stats_add(u64* counter, u64 value) {
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static void stats_sub(u64* counter, u64 value) {
+    __atomic_fetch_sub(counter, value, __ATOMIC_RELAXED);
+}
+
+static u64 stats_get(u64* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static void stats_update_peak(u64* peak, u64 value) {
+    u64 current = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while(value > current &&
+          !__atomic_compare_exchange_n(peak, &current, value, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// The free list is short-lived critical section work, so spin rather than
+// sleep on a kernel object.
+static void heap_lock_acquire() {
+    while(__atomic_exchange_n(&heap_lock, 1, __ATOMIC_ACQUIRE)) {
+        while(__atomic_load_n(&heap_lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void heap_lock_release() {
+    __atomic_store_n(&heap_lock, 0, __ATOMIC_RELEASE);
+}
+
+#if TMEMORY_TRACKING == 1
+typedef struct allocation_record {
+    void* block;
+    u64 size;
+    const char* file;
+    i32 line;
+    u16 alignment;
+    memory_tag tag;
+} allocation_record;
+
+// Open-addressed table of live allocations keyed by pointer. Its storage
+// comes straight from the platform so it never shows up in the stats.
+static allocation_record* records = 0;
+static u64 record_capacity = 0;
+static u64 record_count = 0;
+static volatile i32 tracker_lock = 0;
+
+static void tracker_lock_acquire() {
+    while(__atomic_exchange_n(&tracker_lock, 1, __ATOMIC_ACQUIRE)) {
+        while(__atomic_load_n(&tracker_lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void tracker_lock_release() {
+    __atomic_store_n(&tracker_lock, 0, __ATOMIC_RELEASE);
+}
+
+static u64 tracker_slot(const void* block) {
+    u64 hash = ((u64)block >> 4) * 0x9E3779B97F4A7C15ull;
+    return hash & (record_capacity - 1);
+}
+
+static void tracker_place(allocation_record record) {
+    u64 slot = tracker_slot(record.block);
+    while(records[slot].block) {
+        slot = (slot + 1) & (record_capacity - 1);
+    }
+    records[slot] = record;
+}
+
+static void tracker_grow() {
+    allocation_record* old_records = records;
+    u64 old_capacity = record_capacity;
 
-void initialize_memory() {
+    record_capacity = old_capacity ? old_capacity * 2 : 1024;
+    records = platform_allocate(sizeof(allocation_record) * record_capacity, 0);
+    platform_zero_memory(records, sizeof(allocation_record) * record_capacity);
+    for(u64 i = 0; i < old_capacity; ++i) {
+        if(old_records[i].block) {
+            tracker_place(old_records[i]);
+        }
+    }
+    if(old_records) {
+        platform_free(old_records, 0);
+    }
+}
+
+static void tracker_insert(void* block, u64 size, u16 alignment, memory_tag tag, const char* file, i32 line) {
+    allocation_record record;
+    record.block = block;
+    record.size = size;
+    record.alignment = alignment;
+    record.tag = tag;
+    record.file = file ? file : "(untracked call site)";
+    record.line = line;
+
+    tracker_lock_acquire();
+    if((record_count + 1) * 4 > record_capacity * 3) {
+        tracker_grow();
+    }
+    tracker_place(record);
+    record_count++;
+    tracker_lock_release();
+}
+
+// Checks a free against the recorded allocation and removes the record.
+// The recorded size/alignment/tag replace the caller's values so a bad
+// free cannot corrupt the statistics. Returns FALSE for unknown blocks.
+static b8 tracker_validate_free(void* block, u64* size, u16* alignment, memory_tag* tag, const char* file, i32 line) {
+    if(!file) {
+        file = "(untracked call site)";
+    }
+
+    tracker_lock_acquire();
+    u64 slot = record_capacity ? tracker_slot(block) : 0;
+    while(record_capacity && records[slot].block && records[slot].block != block) {
+        slot = (slot + 1) & (record_capacity - 1);
+    }
+    if(!record_capacity || records[slot].block != block) {
+        tracker_lock_release();
+        TERROR("tfree of unknown or already freed block %p at %s:%i.", block, file, line);
+        return FALSE;
+    }
+
+    allocation_record record = records[slot];
+
+    // Backward-shift deletion keeps probe chains intact without tombstones.
+    u64 hole = slot;
+    u64 next = (slot + 1) & (record_capacity - 1);
+    while(records[next].block) {
+        u64 home = tracker_slot(records[next].block);
+        if(((next - home) & (record_capacity - 1)) >= ((next - hole) & (record_capacity - 1))) {
+            records[hole] = records[next];
+            hole = next;
+        }
+        next = (next + 1) & (record_capacity - 1);
+    }
+    records[hole].block = 0;
+    record_count--;
+    tracker_lock_release();
+
+    if(record.size != *size) {
+        TERROR("tfree size mismatch for %p at %s:%i: freed with %lluB, allocated with %lluB at %s:%i.",
+            block, file, line, *size, record.size, record.file, record.line);
+    }
+    if(record.tag != *tag) {
+        TERROR("tfree tag mismatch for %p at %s:%i: freed as %s, allocated as %s at %s:%i.",
+            block, file, line, memory_tag_strings[*tag], memory_tag_strings[record.tag], record.file, record.line);
+    }
+    if(record.alignment != *alignment) {
+        TERROR("tfree alignment mismatch for %p at %s:%i: freed with %u, allocated with %u at %s:%i.",
+            block, file, line, *alignment, record.alignment, record.file, record.line);
+    }
+
+    *size = record.size;
+    *alignment = record.alignment;
+    *tag = record.tag;
+    return TRUE;
+}
+
+static void tracker_report_leaks() {
+    tracker_lock_acquire();
+    if(record_count == 0) {
+        TINFO("Memory tracker: no leaks detected.");
+    } else {
+        u64 leaked_bytes = 0;
+        for(u64 i = 0; i < record_capacity; ++i) {
+            allocation_record* record = &records[i];
+            if(record->block) {
+                leaked_bytes += record->size;
+                TWARN("Leak: %lluB (%s) at %p, allocated at %s:%i.",
+                    record->size, memory_tag_strings[record->tag], record->block, record->file, record->line);
+            }
+        }
+        TWARN("Memory tracker: %llu allocations leaked, %lluB total.", record_count, leaked_bytes);
+    }
+
+    if(records) {
+        platform_free(records, 0);
+    }
+    records = 0;
+    record_capacity = 0;
+    record_count = 0;
+    tracker_lock_release();
+}
+#endif
+
+b8 initialize_memory(memory_system_config memory_config) {
     platform_zero_memory(&stats, sizeof(stats));
+    platform_zero_memory(&heap, sizeof(heap));
+    platform_zero_memory(&frame_allocator, sizeof(frame_allocator));
+    config = memory_config;
+    use_heap = FALSE;
+
+    if(config.total_alloc_size > 0) {
+        heap_block = platform_allocate(config.total_alloc_size, 64);
+        if(!heap_block || !dynamic_allocator_create(config.total_alloc_size, heap_block, config.fit, &heap)) {
+            TFATAL("Memory system failed to reserve a %lluB heap.", config.total_alloc_size);
+            if(heap_block) {
+                platform_free(heap_block, 64);
+                heap_block = 0;
+            }
+            return FALSE;
+        }
+        use_heap = TRUE;
+    }
+
+    if(config.frame_arena_size > 0) {
+        linear_allocator_create(config.frame_arena_size, 0, &frame_allocator);
+    }
+    return TRUE;
 }
 
 void shutdown_memory() {
+    linear_allocator_destroy(&frame_allocator);
+
+#if TMEMORY_TRACKING == 1
+    tracker_report_leaks();
+#endif
+
+    if(use_heap) {
+        dynamic_allocator_destroy(&heap);
+        platform_free(heap_block, 64);
+        heap_block = 0;
+        use_heap = FALSE;
+    }
 }
 
-void* tallocate(u64 size, memory_tag tag) {
+static void* memory_allocate(u64 size, u16 alignment, memory_tag tag, b8 zero, const char* file, i32 line) {
     if(tag == MEMORY_TAG_UNKNOWN) {
         TWARN("tallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
-    stats.total_allocated += size;
-    stats.tagged_allocations[tag] += size;
+    if(alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        TERROR("tallocate_aligned called with an alignment that is not a power of two: %u", alignment);
+        return 0;
+    }
 
-    // TODO: Memory alignment
-    void* block = platform_allocate(size, FALSE);
-    platform_zero_memory(block, size);
+    void* block = 0;
+    if(use_heap) {
+        heap_lock_acquire();
+        block = dynamic_allocator_allocate_aligned(&heap, size, alignment);
+        heap_lock_release();
+    } else {
+        block = platform_allocate(size, alignment);
+    }
+    if(!block) {
+        TFATAL("tallocate failed to allocate %lluB.", size);
+        return 0;
+    }
+
+#if TMEMORY_TRACKING == 1
+    tracker_insert(block, size, alignment, tag, file, line);
+#endif
+
+    memory_tag_stats* tag_stats = &stats.tags[tag];
+    u64 total = __atomic_add_fetch(&stats.total_allocated, size, __ATOMIC_RELAXED);
+    u64 tag_total = __atomic_add_fetch(&tag_stats->allocated, size, __ATOMIC_RELAXED);
+    stats_update_peak(&stats.peak_total_allocated, total);
+    stats_update_peak(&tag_stats->peak_allocated, tag_total);
+    stats_add(&tag_stats->live_allocations, 1);
+    stats_add(&tag_stats->allocation_count, 1);
+
+    if(zero) {
+        platform_zero_memory(block, size);
+    }
     return block;
 }
 
-void tfree(void* block, u64 size, memory_tag tag) {
+static void memory_free(void* block, u64 size, u16 alignment, memory_tag tag, const char* file, i32 line) {
     if(tag == MEMORY_TAG_UNKNOWN) {
         TWARN("tfree called using MEMORY_TAG_UNKNOWN. Re-class this allocation");
     }
 
-    stats.total_allocated -= size;
-    stats.tagged_allocations[tag] -= size;
+#if TMEMORY_TRACKING == 1
+    if(!tracker_validate_free(block, &size, &alignment, &tag, file, line)) {
+        return;
+    }
+#endif
+
+    memory_tag_stats* tag_stats = &stats.tags[tag];
+    stats_sub(&stats.total_allocated, size);
+    stats_sub(&tag_stats->allocated, size);
+    stats_sub(&tag_stats->live_allocations, 1);
+    stats_add(&tag_stats->free_count, 1);
 
-    // TODO: Memory alignment
-    platform_free(block, FALSE);
+    if(use_heap) {
+        heap_lock_acquire();
+        dynamic_allocator_free(&heap, block);
+        heap_lock_release();
+    } else {
+        platform_free(block, alignment);
+    }
+}
+
+static void* memory_reallocate(void* block, u64 old_size, u64 new_size, memory_tag tag, const char* file, i32 line) {
+    if(!block) {
+        return memory_allocate(new_size, 1, tag, FALSE, file, line);
+    }
+
+#if TMEMORY_TRACKING == 1
+    u16 alignment = 1;
+    memory_tag recorded_tag = tag;
+    if(!tracker_validate_free(block, &old_size, &alignment, &recorded_tag, file, line)) {
+        return 0;
+    }
+#endif
+
+    void* result = 0;
+    if(use_heap) {
+        heap_lock_acquire();
+        result = dynamic_allocator_reallocate(&heap, block, new_size);
+        heap_lock_release();
+    } else {
+        result = platform_reallocate(block, new_size, 1);
+    }
+
+#if TMEMORY_TRACKING == 1
+    if(result) {
+        tracker_insert(result, new_size, 1, tag, file, line);
+    } else {
+        tracker_insert(block, old_size, 1, tag, file, line);
+    }
+#endif
+
+    if(!result) {
+        TFATAL("treallocate failed to resize %lluB to %lluB.", old_size, new_size);
+        return 0;
+    }
+
+    memory_tag_stats* tag_stats = &stats.tags[tag];
+    if(new_size >= old_size) {
+        u64 total = __atomic_add_fetch(&stats.total_allocated, new_size - old_size, __ATOMIC_RELAXED);
+        u64 tag_total = __atomic_add_fetch(&tag_stats->allocated, new_size - old_size, __ATOMIC_RELAXED);
+        stats_update_peak(&stats.peak_total_allocated, total);
+        stats_update_peak(&tag_stats->peak_allocated, tag_total);
+    } else {
+        stats_sub(&stats.total_allocated, old_size - new_size);
+        stats_sub(&tag_stats->allocated, old_size - new_size);
+    }
+    return result;
+}
+
+void* tallocate(u64 size, memory_tag tag) {
+    return memory_allocate(size, 1, tag, TRUE, 0, 0);
+}
+
+void tfree(void* block, u64 size, memory_tag tag) {
+    memory_free(block, size, 1, tag, 0, 0);
 }
 
+void* tallocate_aligned(u64 size, u16 alignment, memory_tag tag) {
+    return memory_allocate(size, alignment, tag, TRUE, 0, 0);
+}
+
+void* tallocate_uninitialized(u64 size, memory_tag tag) {
+    return memory_allocate(size, 1, tag, FALSE, 0, 0);
+}
+
+void tfree_aligned(void* block, u64 size, u16 alignment, memory_tag tag) {
+    memory_free(block, size, alignment, tag, 0, 0);
+}
+
+void* treallocate(void* block, u64 old_size, u64 new_size, memory_tag tag) {
+    return memory_reallocate(block, old_size, new_size, tag, 0, 0);
+}
+
+#if TMEMORY_TRACKING == 1
+void* _tallocate_tracked(u64 size, u16 alignment, memory_tag tag, b8 zero, const char* file, i32 line) {
+    return memory_allocate(size, alignment, tag, zero, file, line);
+}
+
+void* _treallocate_tracked(void* block, u64 old_size, u64 new_size, memory_tag tag, const char* file, i32 line) {
+    return memory_reallocate(block, old_size, new_size, tag, file, line);
+}
+
+void _tfree_tracked(void* block, u64 size, u16 alignment, memory_tag tag, const char* file, i32 line) {
+    memory_free(block, size, alignment, tag, file, line);
+}
+#endif
+
 void* tzero_memory(void* block, u64 size) {
     return platform_zero_memory(block, size);
 }
@@ -73,38 +442,170 @@ TAPI void* tcopy_memory(void* dest, const void* source, u64 size) {
     return platform_copy_memory(dest, source, size);
 }
 
+TAPI void* tmove_memory(void* dest, const void* source, u64 size) {
+    return platform_move_memory(dest, source, size);
+}
+
 TAPI void* tset_memory(void* dest, i32 value, u64 size) {
     return platform_set_memory(dest, value, size);
 }
 
-TAPI char* get_memory_usage_str() {
+void* tallocate_frame(u64 size) {
+    return linear_allocator_allocate(&frame_allocator, size);
+}
+
+void memory_frame_reset() {
+    linear_allocator_free_all(&frame_allocator);
+}
+
+static f32 get_size_unit(u64 bytes, char* out_unit) {
     const u64 gib = 1024 * 1024 * 1024;
     const u64 mib = 1024 * 1024;
     const u64 kib = 1024;
 
-    char buffer[8000] = "System memory use (tagged):\n";
-    u64 offset = string_length(buffer);
+    out_unit[1] = 'i';
+    out_unit[2] = 'B';
+    out_unit[3] = 0;
+    if(bytes >= gib) {
+        out_unit[0] = 'G';
+        return bytes / (f32)gib;
+    } else if(bytes >= mib) {
+        out_unit[0] = 'M';
+        return bytes / (f32)mib;
+    } else if(bytes >= kib) {
+        out_unit[0] = 'K';
+        return bytes / (f32)kib;
+    }
+    out_unit[0] = 'B';
+    out_unit[1] = 0;
+    return (f32)bytes;
+}
+
+void get_memory_stats(memory_stats* out_stats) {
+    out_stats->total_allocated = stats_get(&stats.total_allocated);
+    out_stats->peak_total_allocated = stats_get(&stats.peak_total_allocated);
+    for(u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+        memory_tag_stats* source = &stats.tags[i];
+        memory_tag_stats* dest = &out_stats->tags[i];
+        dest->allocated = stats_get(&source->allocated);
+        dest->peak_allocated = stats_get(&source->peak_allocated);
+        dest->live_allocations = stats_get(&source->live_allocations);
+        dest->allocation_count = stats_get(&source->allocation_count);
+        dest->free_count = stats_get(&source->free_count);
+    }
+}
+
+// snprintf-style append that never runs past the buffer and keeps offset
+// pointing at the terminator when the output is truncated.
+static void append_format(char* buffer, u64 buffer_size, u64* offset, const char* format, ...) {
+    if(*offset + 1 >= buffer_size) {
+        return;
+    }
+
+    __builtin_va_list arg_ptr;
+    va_start(arg_ptr, format);
+    i32 length = vsnprintf(buffer + *offset, buffer_size - *offset, format, arg_ptr);
+    va_end(arg_ptr);
+
+    if(length < 0) {
+        return;
+    }
+    if(*offset + length >= buffer_size) {
+        *offset = buffer_size - 1;
+    } else {
+        *offset += length;
+    }
+}
+
+static u64 get_heap_free_space() {
+    heap_lock_acquire();
+    u64 free_space = dynamic_allocator_free_space(&heap);
+    heap_lock_release();
+    return free_space;
+}
+
+u64 get_memory_usage(char* buffer, u64 buffer_size) {
+    if(!buffer || buffer_size == 0) {
+        return 0;
+    }
+
+    memory_stats snapshot;
+    get_memory_stats(&snapshot);
+
+    u64 offset = 0;
+    buffer[0] = 0;
+    append_format(buffer, buffer_size, &offset, "System memory use (tagged):\n");
     for(u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
-        char unit[4] = "XiB";
-        float amount = 1.0f;
-        if(stats.tagged_allocations[i] >= gib) {
-            unit[0] = 'G';
-            amount = stats.tagged_allocations[i] / (float)gib;
-        } else if(stats.tagged_allocations[i] >= mib) {
-            unit[0] = 'M';
-            amount = stats.tagged_allocations[i] / (float)mib;
-        } else if(stats.tagged_allocations[i] >= kib) {
-            unit[0] = 'K';
-            amount = stats.tagged_allocations[i] / (float)kib;
-        } else {
-            unit[0] = 'B';
-            unit[1] = 0;
-            amount = (float)stats.tagged_allocations[i];
+        memory_tag_stats* tag_stats = &snapshot.tags[i];
+        char unit[4];
+        char peak_unit[4];
+        f32 amount = get_size_unit(tag_stats->allocated, unit);
+        f32 peak_amount = get_size_unit(tag_stats->peak_allocated, peak_unit);
+
+        append_format(buffer, buffer_size, &offset, " %s: %.2f%s (peak %.2f%s, live %llu, allocs %llu, frees %llu)\n",
+            memory_tag_strings[i], amount, unit, peak_amount, peak_unit,
+            tag_stats->live_allocations, tag_stats->allocation_count, tag_stats->free_count);
+    }
+
+    char used_unit[4];
+    char high_water_unit[4];
+    char total_unit[4];
+    f32 used = get_size_unit(frame_allocator.allocated, used_unit);
+    f32 high_water = get_size_unit(frame_allocator.high_water_mark, high_water_unit);
+    f32 total = get_size_unit(frame_allocator.total_size, total_unit);
+    append_format(buffer, buffer_size, &offset, "Frame arena: %.2f%s used, %.2f%s high-water, %.2f%s total\n",
+        used, used_unit, high_water, high_water_unit, total, total_unit);
+
+    if(use_heap) {
+        char free_unit[4];
+        char heap_unit[4];
+        f32 free_amount = get_size_unit(get_heap_free_space(), free_unit);
+        f32 heap_amount = get_size_unit(heap.total_size, heap_unit);
+        append_format(buffer, buffer_size, &offset, "Heap: %.2f%s free of %.2f%s\n",
+            free_amount, free_unit, heap_amount, heap_unit);
+    }
+
+    return offset;
+}
+
+u64 get_memory_usage_kv(char* buffer, u64 buffer_size) {
+    if(!buffer || buffer_size == 0) {
+        return 0;
+    }
+
+    memory_stats snapshot;
+    get_memory_stats(&snapshot);
+
+    u64 offset = 0;
+    buffer[0] = 0;
+    append_format(buffer, buffer_size, &offset, "memory total=%llu peak=%llu\n",
+        snapshot.total_allocated, snapshot.peak_total_allocated);
+    for(u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+        memory_tag_stats* tag_stats = &snapshot.tags[i];
+
+        // The display names are padded for the table above.
+        i32 name_length = (i32)string_length(memory_tag_strings[i]);
+        while(name_length > 0 && memory_tag_strings[i][name_length - 1] == ' ') {
+            name_length--;
         }
 
-        i32 length = snprintf(buffer + offset, 8000, " %s: %.2f%s\n", memory_tag_strings[i], amount, unit);
-        offset += length;
+        append_format(buffer, buffer_size, &offset, "memory tag=%.*s bytes=%llu peak=%llu live=%llu allocs=%llu frees=%llu\n",
+            name_length, memory_tag_strings[i], tag_stats->allocated, tag_stats->peak_allocated,
+            tag_stats->live_allocations, tag_stats->allocation_count, tag_stats->free_count);
+    }
+
+    append_format(buffer, buffer_size, &offset, "memory frame_arena_used=%llu frame_arena_high_water=%llu frame_arena_size=%llu\n",
+        frame_allocator.allocated, frame_allocator.high_water_mark, frame_allocator.total_size);
+    if(use_heap) {
+        append_format(buffer, buffer_size, &offset, "memory heap_free=%llu heap_size=%llu\n",
+            get_heap_free_space(), heap.total_size);
     }
-    char* out_string = string_duplicate(buffer);
-    return out_string;
-}
\ No newline at end of file
+
+    return offset;
+}
+
+char* get_memory_usage_str() {
+    char buffer[8000];
+    get_memory_usage(buffer, sizeof(buffer));
+    return string_duplicate(buffer);
+}
@@ -1,6 +1,23 @@
 #pragma once
 
 #include "defines.h"
+#include "memory/dynamic_allocator.h"
+
+#ifndef MEMORY_FRAME_ARENA_SIZE
+#define MEMORY_FRAME_ARENA_SIZE (4 * 1024 * 1024)
+#endif
+
+// Set to 1 (engine and game alike) to record every live allocation with
+// its call site, validate sizes on free and report leaks at shutdown.
+#ifndef TMEMORY_TRACKING
+#define TMEMORY_TRACKING 0
+#endif
+
+// Size of the engine heap reserved at startup. 0 keeps every tallocate
+// going straight to the platform allocator.
+#ifndef MEMORY_HEAP_SIZE
+#define MEMORY_HEAP_SIZE 0
+#endif
 
 typedef enum memory_tag {
     MEMORY_TAG_UNKNOWN,
@@ -20,16 +37,102 @@ typedef enum memory_tag {
     MEMORY_TAG_ENTITY,
     MEMORY_TAG_ENTITY_MODE,
     MEMORY_TAG_SCENE,
+    MEMORY_TAG_LINEAR_ALLOCATOR,
+    MEMORY_TAG_EVENT,
 
     MEMORY_TAG_MAX_TAGS
 } memory_tag;
 
-TAPI void initialize_memory();
+typedef struct memory_system_config {
+    // When non-zero, one block of this size is reserved up front and every
+    // tallocate is served from it by a free-list allocator.
+    u64 total_alloc_size;
+    dynamic_allocator_fit fit;
+    u64 frame_arena_size;
+} memory_system_config;
+
+typedef struct memory_tag_stats {
+    u64 allocated;
+    u64 peak_allocated;
+    u64 live_allocations;
+    // Lifetime number of allocate/free calls, to spot tags that churn.
+    u64 allocation_count;
+    u64 free_count;
+} memory_tag_stats;
+
+typedef struct memory_stats {
+    u64 total_allocated;
+    u64 peak_total_allocated;
+    memory_tag_stats tags[MEMORY_TAG_MAX_TAGS];
+} memory_stats;
+
+TAPI b8 initialize_memory(memory_system_config config);
 TAPI void shutdown_memory();
 
 TAPI void* tallocate(u64 size, memory_tag tag);
 TAPI void tfree(void* block, u64 size, memory_tag tag);
+
+// Same as tallocate but skips zeroing. Use when the caller overwrites the
+// whole block (or tracks which part is valid) before reading it. Free with
+// tfree.
+TAPI void* tallocate_uninitialized(u64 size, memory_tag tag);
+
+// Resizes a block from tallocate/tallocate_uninitialized, in place when the
+// allocator can. Contents up to the smaller size are kept; bytes past
+// old_size are not zeroed. Returns 0 on failure and leaves block valid.
+TAPI void* treallocate(void* block, u64 old_size, u64 new_size, memory_tag tag);
+
+// alignment must be a power of two. Blocks must be released with
+// tfree_aligned using the same size, alignment and tag.
+TAPI void* tallocate_aligned(u64 size, u16 alignment, memory_tag tag);
+TAPI void tfree_aligned(void* block, u64 size, u16 alignment, memory_tag tag);
 TAPI void* tzero_memory(void* block, u64 size);
 TAPI void* tcopy_memory(void* dest, const void* source, u64 size);
+// Like tcopy_memory, but source and dest may overlap.
+TAPI void* tmove_memory(void* dest, const void* source, u64 size);
 TAPI void* tset_memory(void* dest, i32 value, u64 size);
-TAPI char* get_memory_usage_str();
\ No newline at end of file
+
+// Per-frame scratch memory for the main thread. Allocations are a pointer
+// bump, are not zeroed and stay valid until the next memory_frame_reset,
+// which the application calls once at the start of every loop iteration.
+TAPI void* tallocate_frame(u64 size);
+TAPI void memory_frame_reset();
+
+TAPI void get_memory_stats(memory_stats* out_stats);
+
+// Writes a human readable usage table into buffer and returns the number
+// of characters written, excluding the terminator. Output is truncated to
+// fit; nothing is allocated.
+TAPI u64 get_memory_usage(char* buffer, u64 buffer_size);
+
+// Same data as one "memory key=value ..." line per record, for machine
+// parsing. Byte values are raw integers.
+TAPI u64 get_memory_usage_kv(char* buffer, u64 buffer_size);
+
+// Heap-allocated copy of get_memory_usage. Release with
+// tfree(str, string_length(str) + 1, MEMORY_TAG_STRING).
+TAPI char* get_memory_usage_str();
+
+#if TMEMORY_TRACKING == 1
+TAPI void* _tallocate_tracked(u64 size, u16 alignment, memory_tag tag, b8 zero, const char* file, i32 line);
+TAPI void* _treallocate_tracked(void* block, u64 old_size, u64 new_size, memory_tag tag, const char* file, i32 line);
+TAPI void _tfree_tracked(void* block, u64 size, u16 alignment, memory_tag tag, const char* file, i32 line);
+
+#define tallocate(size, tag) \
+    _tallocate_tracked(size, 1, tag, TRUE, __FILE__, __LINE__)
+
+#define tallocate_aligned(size, alignment, tag) \
+    _tallocate_tracked(size, alignment, tag, TRUE, __FILE__, __LINE__)
+
+#define tallocate_uninitialized(size, tag) \
+    _tallocate_tracked(size, 1, tag, FALSE, __FILE__, __LINE__)
+
+#define treallocate(block, old_size, new_size, tag) \
+    _treallocate_tracked(block, old_size, new_size, tag, __FILE__, __LINE__)
+
+#define tfree(block, size, tag) \
+    _tfree_tracked(block, size, 1, tag, __FILE__, __LINE__)
+
+#define tfree_aligned(block, size, alignment, tag) \
+    _tfree_tracked(block, size, alignment, tag, __FILE__, __LINE__)
+#endif
\ No newline at end of file
@@ -9,7 +9,7 @@ u64 string_length(const char* str) {
 
 char* string_duplicate(const char* str) {
     u64 length = string_length(str);
-    char* copy = tallocate(length + 1, MEMORY_TAG_STRING);
+    char* copy = tallocate_uninitialized(length + 1, MEMORY_TAG_STRING);
     tcopy_memory(copy, str, length + 1);
     return copy;
 }
@@ -82,4 +82,10 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #endif
 #endif
 
+#ifdef _MSC_VER
+#define TNOINLINE __declspec(noinline)
+#else
+#define TNOINLINE __attribute__((noinline))
+#endif
+
 #define TCLAMP(value, min, max) (value <= min) ? min : (value >= max) ? max : value;
\ No newline at end of file
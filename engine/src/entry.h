@@ -9,9 +9,16 @@ extern b8 create_game(game* out_game);
 
 // Main entry
 int main(void) {
-    initialize_memory();
+    memory_system_config memory_config = {};
+    memory_config.total_alloc_size = MEMORY_HEAP_SIZE;
+    memory_config.fit = DYNAMIC_ALLOCATOR_FIT_FIRST;
+    memory_config.frame_arena_size = MEMORY_FRAME_ARENA_SIZE;
+    if(!initialize_memory(memory_config)) {
+        TFATAL("Failed to initialize memory system!");
+        return -1;
+    }
 
-    game game_inst;
+    game game_inst = {};
     if(!create_game(&game_inst)) {
         TFATAL("Could not create game!");
         return -1;
@@ -0,0 +1,268 @@
+#include "memory/dynamic_allocator.h"
+
+#include "core/logger.h"
+#include "platform/platform.h"
+
+// Every block handed out or kept on the free list is a multiple of this.
+#define DYNAMIC_ALLOCATOR_GRANULARITY 16
+
+typedef struct dynamic_allocator_node {
+    u64 size;
+    struct dynamic_allocator_node* next;
+} dynamic_allocator_node;
+
+// Stored directly in front of every pointer returned to the caller.
+typedef struct dynamic_allocator_header {
+    u64 offset : 48;
+    // As requested, so a block that has to move keeps it.
+    u64 alignment : 16;
+    u64 size;
+} dynamic_allocator_header;
+
+STATIC_ASSERT(sizeof(dynamic_allocator_node) == DYNAMIC_ALLOCATOR_GRANULARITY, "Free list node must match the allocator granularity.");
+STATIC_ASSERT(sizeof(dynamic_allocator_header) == DYNAMIC_ALLOCATOR_GRANULARITY, "Allocation header must match the allocator granularity.");
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+b8 dynamic_allocator_create(u64 total_size, void* memory, dynamic_allocator_fit fit, dynamic_allocator* out_allocator) {
+    if(!out_allocator || !memory) {
+        TERROR("dynamic_allocator_create requires a valid memory block and out_allocator.");
+        return FALSE;
+    }
+    if(((u64)memory % DYNAMIC_ALLOCATOR_GRANULARITY) != 0) {
+        TERROR("dynamic_allocator_create - memory must be %i-byte aligned.", DYNAMIC_ALLOCATOR_GRANULARITY);
+        return FALSE;
+    }
+
+    u64 usable_size = total_size & ~(u64)(DYNAMIC_ALLOCATOR_GRANULARITY - 1);
+    if(usable_size < DYNAMIC_ALLOCATOR_GRANULARITY * 2) {
+        TERROR("dynamic_allocator_create - total_size of %lluB is too small.", total_size);
+        return FALSE;
+    }
+    if(usable_size >> 48) {
+        TERROR("dynamic_allocator_create - total_size of %lluB is too large.", total_size);
+        return FALSE;
+    }
+
+    out_allocator->total_size = usable_size;
+    out_allocator->memory = memory;
+    out_allocator->fit = fit;
+    out_allocator->head = (dynamic_allocator_node*)memory;
+    out_allocator->head->size = usable_size;
+    out_allocator->head->next = 0;
+    return TRUE;
+}
+
+void dynamic_allocator_destroy(dynamic_allocator* allocator) {
+    if(allocator) {
+        allocator->total_size = 0;
+        allocator->memory = 0;
+        allocator->head = 0;
+    }
+}
+
+void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size) {
+    return dynamic_allocator_allocate_aligned(allocator, size, DYNAMIC_ALLOCATOR_GRANULARITY);
+}
+
+void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u16 alignment) {
+    if(!allocator || !allocator->memory || size == 0) {
+        return 0;
+    }
+    if(alignment < DYNAMIC_ALLOCATOR_GRANULARITY) {
+        alignment = DYNAMIC_ALLOCATOR_GRANULARITY;
+    }
+
+    // Blocks start on the granularity, so only alignments above it need padding.
+    u64 padding = alignment - DYNAMIC_ALLOCATOR_GRANULARITY;
+    u64 required = align_up(sizeof(dynamic_allocator_header) + padding + size, DYNAMIC_ALLOCATOR_GRANULARITY);
+
+    dynamic_allocator_node* previous = 0;
+    dynamic_allocator_node* node = allocator->head;
+    dynamic_allocator_node* found_previous = 0;
+    dynamic_allocator_node* found = 0;
+    while(node) {
+        if(node->size >= required) {
+            if(!found || node->size < found->size) {
+                found = node;
+                found_previous = previous;
+            }
+            if(allocator->fit == DYNAMIC_ALLOCATOR_FIT_FIRST || node->size == required) {
+                break;
+            }
+        }
+        previous = node;
+        node = node->next;
+    }
+
+    if(!found) {
+        TWARN("dynamic_allocator_allocate - No free block large enough for %lluB (alignment %u).", size, alignment);
+        return 0;
+    }
+
+    // Carve from the front of the free block so the space after an
+    // allocation stays free for as long as possible.
+    dynamic_allocator_node* replacement = found->next;
+    if(found->size > required) {
+        replacement = (dynamic_allocator_node*)((u8*)found + required);
+        replacement->size = found->size - required;
+        replacement->next = found->next;
+    }
+    if(found_previous) {
+        found_previous->next = replacement;
+    } else {
+        allocator->head = replacement;
+    }
+
+    u64 block_start = (u64)found;
+    u64 user = align_up(block_start + sizeof(dynamic_allocator_header), alignment);
+    dynamic_allocator_header* header = (dynamic_allocator_header*)(user - sizeof(dynamic_allocator_header));
+    header->offset = block_start - (u64)allocator->memory;
+    header->alignment = alignment;
+    header->size = required;
+    return (void*)user;
+}
+
+// Returns the allocation header of block, or 0 if block does not belong to
+// the allocator or its header is damaged.
+static dynamic_allocator_header* get_header(dynamic_allocator* allocator, void* block, const char* caller) {
+    if(!dynamic_allocator_owns(allocator, block)) {
+        TERROR("%s - Block %p is not owned by this allocator.", caller, block);
+        return 0;
+    }
+
+    dynamic_allocator_header* header = (dynamic_allocator_header*)((u8*)block - sizeof(dynamic_allocator_header));
+    if(header->offset + header->size > allocator->total_size || header->size == 0) {
+        TERROR("%s - Block %p has a corrupt header.", caller, block);
+        return 0;
+    }
+    return header;
+}
+
+// Puts a range back on the address-ordered free list, merging it with
+// its neighbours.
+static b8 insert_free_block(dynamic_allocator* allocator, void* start, u64 size) {
+    dynamic_allocator_node* freed = (dynamic_allocator_node*)start;
+
+    dynamic_allocator_node* previous = 0;
+    dynamic_allocator_node* node = allocator->head;
+    while(node && node < freed) {
+        previous = node;
+        node = node->next;
+    }
+    if(node == freed || (previous && (u8*)previous + previous->size > (u8*)freed)) {
+        return FALSE;
+    }
+
+    freed->size = size;
+    freed->next = node;
+    if(node && (u8*)freed + freed->size == (u8*)node) {
+        freed->size += node->size;
+        freed->next = node->next;
+    }
+
+    if(previous) {
+        if((u8*)previous + previous->size == (u8*)freed) {
+            previous->size += freed->size;
+            previous->next = freed->next;
+        } else {
+            previous->next = freed;
+        }
+    } else {
+        allocator->head = freed;
+    }
+    return TRUE;
+}
+
+b8 dynamic_allocator_free(dynamic_allocator* allocator, void* block) {
+    if(!allocator || !block) {
+        return FALSE;
+    }
+
+    dynamic_allocator_header* header = get_header(allocator, block, "dynamic_allocator_free");
+    if(!header) {
+        return FALSE;
+    }
+
+    if(!insert_free_block(allocator, (u8*)allocator->memory + header->offset, header->size)) {
+        TERROR("dynamic_allocator_free - Double free of block %p.", block);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void* dynamic_allocator_reallocate(dynamic_allocator* allocator, void* block, u64 size) {
+    if(!allocator || !block || size == 0) {
+        return 0;
+    }
+
+    dynamic_allocator_header* header = get_header(allocator, block, "dynamic_allocator_reallocate");
+    if(!header) {
+        return 0;
+    }
+
+    u8* block_start = (u8*)allocator->memory + header->offset;
+    u64 user_offset = (u8*)block - block_start;
+    u64 required = align_up(user_offset + size, DYNAMIC_ALLOCATOR_GRANULARITY);
+
+    if(required <= header->size) {
+        // Shrinking: hand the tail back to the free list.
+        if(required < header->size) {
+            insert_free_block(allocator, block_start + required, header->size - required);
+            header->size = required;
+        }
+        return block;
+    }
+
+    // Growing: if the block is directly followed by a large enough free
+    // block, take the front of it and keep the data where it is.
+    u64 extra = required - header->size;
+    u8* block_end = block_start + header->size;
+    dynamic_allocator_node* previous = 0;
+    dynamic_allocator_node* node = allocator->head;
+    while(node && (u8*)node < block_end) {
+        previous = node;
+        node = node->next;
+    }
+    if(node && (u8*)node == block_end && node->size >= extra) {
+        dynamic_allocator_node* replacement = node->next;
+        if(node->size > extra) {
+            replacement = (dynamic_allocator_node*)(block_end + extra);
+            replacement->size = node->size - extra;
+            replacement->next = node->next;
+        }
+        if(previous) {
+            previous->next = replacement;
+        } else {
+            allocator->head = replacement;
+        }
+        header->size = required;
+        return block;
+    }
+
+    // Otherwise move it, keeping the original alignment.
+    u64 old_size = header->size - user_offset;
+    void* moved = dynamic_allocator_allocate_aligned(allocator, size, (u16)header->alignment);
+    if(!moved) {
+        return 0;
+    }
+    platform_copy_memory(moved, block, old_size < size ? old_size : size);
+    dynamic_allocator_free(allocator, block);
+    return moved;
+}
+
+b8 dynamic_allocator_owns(dynamic_allocator* allocator, const void* block) {
+    u64 address = (u64)block;
+    u64 start = (u64)allocator->memory;
+    return address >= start + sizeof(dynamic_allocator_header) && address < start + allocator->total_size;
+}
+
+u64 dynamic_allocator_free_space(dynamic_allocator* allocator) {
+    u64 total = 0;
+    for(dynamic_allocator_node* node = allocator->head; node; node = node->next) {
+        total += node->size;
+    }
+    return total;
+}
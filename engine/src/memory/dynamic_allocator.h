@@ -0,0 +1,39 @@
+#pragma once
+
+#include "defines.h"
+
+typedef enum dynamic_allocator_fit {
+    // Take the first free block that is large enough.
+    DYNAMIC_ALLOCATOR_FIT_FIRST,
+    // Take the smallest free block that is large enough.
+    DYNAMIC_ALLOCATOR_FIT_BEST
+} dynamic_allocator_fit;
+
+struct dynamic_allocator_node;
+
+// General-purpose allocator over a single caller-provided block. Free
+// blocks are kept in an address-ordered list that lives inside the free
+// memory itself and neighbouring free blocks are merged on free.
+typedef struct dynamic_allocator {
+    u64 total_size;
+    void* memory;
+    dynamic_allocator_fit fit;
+    struct dynamic_allocator_node* head;
+} dynamic_allocator;
+
+// memory must be at least 16-byte aligned and outlive the allocator.
+TAPI b8 dynamic_allocator_create(u64 total_size, void* memory, dynamic_allocator_fit fit, dynamic_allocator* out_allocator);
+TAPI void dynamic_allocator_destroy(dynamic_allocator* allocator);
+
+// Returned memory is not zeroed.
+TAPI void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size);
+TAPI void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u16 alignment);
+TAPI b8 dynamic_allocator_free(dynamic_allocator* allocator, void* block);
+
+// Grows or shrinks block, in place when the neighbouring memory allows it.
+// Contents up to the smaller size are kept; new bytes are not zeroed. On
+// failure returns 0 and block is left untouched.
+TAPI void* dynamic_allocator_reallocate(dynamic_allocator* allocator, void* block, u64 size);
+
+TAPI b8 dynamic_allocator_owns(dynamic_allocator* allocator, const void* block);
+TAPI u64 dynamic_allocator_free_space(dynamic_allocator* allocator);
@@ -0,0 +1,63 @@
+#include "memory/linear_allocator.h"
+
+#include "core/tmemory.h"
+#include "core/logger.h"
+
+void linear_allocator_create(u64 total_size, void* memory, linear_allocator* out_allocator) {
+    if(!out_allocator) {
+        return;
+    }
+
+    out_allocator->total_size = total_size;
+    out_allocator->allocated = 0;
+    out_allocator->high_water_mark = 0;
+    out_allocator->owns_memory = memory == 0;
+    if(memory) {
+        out_allocator->memory = memory;
+    } else {
+        out_allocator->memory = tallocate(total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+}
+
+void linear_allocator_destroy(linear_allocator* allocator) {
+    if(!allocator) {
+        return;
+    }
+
+    if(allocator->owns_memory && allocator->memory) {
+        tfree(allocator->memory, allocator->total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+    allocator->memory = 0;
+    allocator->total_size = 0;
+    allocator->allocated = 0;
+    allocator->high_water_mark = 0;
+    allocator->owns_memory = FALSE;
+}
+
+void* linear_allocator_allocate(linear_allocator* allocator, u64 size) {
+    if(!allocator || !allocator->memory) {
+        TERROR("linear_allocator_allocate - allocator is not initialized.");
+        return 0;
+    }
+
+    // Keep every allocation 16-byte aligned.
+    u64 aligned_size = (size + 15) & ~(u64)15;
+    if(allocator->allocated + aligned_size > allocator->total_size) {
+        u64 remaining = allocator->total_size - allocator->allocated;
+        TERROR("linear_allocator_allocate - Tried to allocate %lluB, only %lluB remaining.", size, remaining);
+        return 0;
+    }
+
+    void* block = ((u8*)allocator->memory) + allocator->allocated;
+    allocator->allocated += aligned_size;
+    if(allocator->allocated > allocator->high_water_mark) {
+        allocator->high_water_mark = allocator->allocated;
+    }
+    return block;
+}
+
+void linear_allocator_free_all(linear_allocator* allocator) {
+    if(allocator && allocator->memory) {
+        allocator->allocated = 0;
+    }
+}
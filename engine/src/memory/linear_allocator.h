@@ -0,0 +1,21 @@
+#pragma once
+
+#include "defines.h"
+
+// Bump allocator. Individual allocations cannot be freed; the whole
+// allocator is reset at once with linear_allocator_free_all.
+typedef struct linear_allocator {
+    u64 total_size;
+    u64 allocated;
+    u64 high_water_mark;
+    void* memory;
+    b8 owns_memory;
+} linear_allocator;
+
+// If memory is 0 the allocator reserves its own block of total_size bytes.
+TAPI void linear_allocator_create(u64 total_size, void* memory, linear_allocator* out_allocator);
+TAPI void linear_allocator_destroy(linear_allocator* allocator);
+
+// Returned memory is not zeroed.
+TAPI void* linear_allocator_allocate(linear_allocator* allocator, u64 size);
+TAPI void linear_allocator_free_all(linear_allocator* allocator);
@@ -0,0 +1,109 @@
+#include "memory/pool_allocator.h"
+
+#include "core/logger.h"
+
+#define POOL_ALLOCATOR_ALIGNMENT 16
+
+// Sits at the start of every chunk, padded to the block alignment.
+typedef struct pool_chunk_header {
+    struct pool_chunk_header* next;
+} pool_chunk_header;
+
+static u64 get_chunk_size(pool_allocator* allocator) {
+    return POOL_ALLOCATOR_ALIGNMENT + allocator->block_size * allocator->blocks_per_chunk;
+}
+
+static b8 add_chunk(pool_allocator* allocator) {
+    u8* chunk = tallocate_aligned(get_chunk_size(allocator), POOL_ALLOCATOR_ALIGNMENT, allocator->tag);
+    if(!chunk) {
+        return FALSE;
+    }
+
+    pool_chunk_header* header = (pool_chunk_header*)chunk;
+    header->next = allocator->chunks;
+    allocator->chunks = header;
+    allocator->chunk_count++;
+
+    // Link the blocks in address order so consecutive allocations are
+    // adjacent in memory.
+    u8* first = chunk + POOL_ALLOCATOR_ALIGNMENT;
+    for(u64 i = 0; i < allocator->blocks_per_chunk - 1; ++i) {
+        *(void**)(first + i * allocator->block_size) = first + (i + 1) * allocator->block_size;
+    }
+    *(void**)(first + (allocator->blocks_per_chunk - 1) * allocator->block_size) = allocator->free_list;
+    allocator->free_list = first;
+    return TRUE;
+}
+
+b8 pool_allocator_create(u64 block_size, u64 blocks_per_chunk, b8 can_grow, memory_tag tag, pool_allocator* out_allocator) {
+    if(!out_allocator || block_size == 0 || blocks_per_chunk == 0) {
+        TERROR("pool_allocator_create requires a non-zero block size and block count.");
+        return FALSE;
+    }
+
+    if(block_size < sizeof(void*)) {
+        block_size = sizeof(void*);
+    }
+    block_size = (block_size + POOL_ALLOCATOR_ALIGNMENT - 1) & ~(u64)(POOL_ALLOCATOR_ALIGNMENT - 1);
+
+    out_allocator->block_size = block_size;
+    out_allocator->blocks_per_chunk = blocks_per_chunk;
+    out_allocator->can_grow = can_grow;
+    out_allocator->tag = tag;
+    out_allocator->chunk_count = 0;
+    out_allocator->allocated_count = 0;
+    out_allocator->free_list = 0;
+    out_allocator->chunks = 0;
+
+    return add_chunk(out_allocator);
+}
+
+void pool_allocator_destroy(pool_allocator* allocator) {
+    if(!allocator) {
+        return;
+    }
+
+    if(allocator->allocated_count > 0) {
+        TWARN("pool_allocator_destroy - %llu blocks are still allocated.", allocator->allocated_count);
+    }
+
+    u64 chunk_size = get_chunk_size(allocator);
+    pool_chunk_header* chunk = allocator->chunks;
+    while(chunk) {
+        pool_chunk_header* next = chunk->next;
+        tfree_aligned(chunk, chunk_size, POOL_ALLOCATOR_ALIGNMENT, allocator->tag);
+        chunk = next;
+    }
+
+    allocator->chunks = 0;
+    allocator->free_list = 0;
+    allocator->chunk_count = 0;
+    allocator->allocated_count = 0;
+}
+
+void* pool_allocator_allocate(pool_allocator* allocator) {
+    if(!allocator->free_list) {
+        if(!allocator->can_grow) {
+            TWARN("pool_allocator_allocate - Pool of %llu blocks is full.", allocator->blocks_per_chunk);
+            return 0;
+        }
+        if(!add_chunk(allocator)) {
+            return 0;
+        }
+    }
+
+    void* block = allocator->free_list;
+    allocator->free_list = *(void**)block;
+    allocator->allocated_count++;
+    return block;
+}
+
+void pool_allocator_free(pool_allocator* allocator, void* block) {
+    if(!block) {
+        return;
+    }
+
+    *(void**)block = allocator->free_list;
+    allocator->free_list = block;
+    allocator->allocated_count--;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "defines.h"
+#include "core/tmemory.h"
+
+// Fixed-size block allocator. Blocks are carved out of chunks that are
+// allocated through tallocate under the pool's tag, so the tag statistics
+// show the memory reserved for that object type. Free blocks form an
+// intrusive singly linked list, making allocate and free O(1).
+typedef struct pool_allocator {
+    u64 block_size;
+    u64 blocks_per_chunk;
+    b8 can_grow;
+    memory_tag tag;
+    u64 chunk_count;
+    u64 allocated_count;
+    void* free_list;
+    void* chunks;
+} pool_allocator;
+
+TAPI b8 pool_allocator_create(u64 block_size, u64 blocks_per_chunk, b8 can_grow, memory_tag tag, pool_allocator* out_allocator);
+TAPI void pool_allocator_destroy(pool_allocator* allocator);
+
+// Returned memory is not zeroed. Returns 0 when the pool is full and
+// cannot grow.
+TAPI void* pool_allocator_allocate(pool_allocator* allocator);
+TAPI void pool_allocator_free(pool_allocator* allocator, void* block);
+
+#define pool_allocator_create_typed(type, blocks_per_chunk, can_grow, tag, out_allocator) \
+    pool_allocator_create(sizeof(type), blocks_per_chunk, can_grow, tag, out_allocator)
+
+#define pool_allocator_allocate_typed(type, allocator) \
+    (type*)pool_allocator_allocate(allocator)
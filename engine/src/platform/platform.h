@@ -19,15 +19,88 @@ b8 platform_startup(
 void platform_shutdown(platform_state* plat_state);
 b8 platform_pump_messages(platform_state* plat_state);
 
-void* platform_allocate(u64 size, b8 aligned);
-void platform_free(void* block, b8 aligned);
+// An alignment of 0 or 1 uses the default allocator alignment. Blocks must
+// be freed with the same alignment they were allocated with.
+void* platform_allocate(u64 size, u16 alignment);
+void platform_free(void* block, u16 alignment);
+// Contents up to the smaller size are kept. Returns 0 on failure, leaving
+// block untouched.
+void* platform_reallocate(void* block, u64 size, u16 alignment);
 void* platform_zero_memory(void* block, u64 size);
 void* platform_copy_memory(void* dest, const void* source, u64 size);
+void* platform_move_memory(void* dest, const void* source, u64 size);
 void* platform_set_memory(void* dest, i32 value, u64 size);
 
 void platform_console_write(const char* message, u8 color);
 void platform_console_write_error(const char* message, u8 color);
 
-f64 platform_get_absolute_time();
+// The TAPI functions below are also used by the programs in tools/.
+TAPI f64 platform_get_absolute_time();
 
-void platform_sleep(u64 ms);
\ No newline at end of file
+TAPI void platform_sleep(u64 ms);
+
+typedef u32 (*PFN_thread_start)(void* param);
+
+typedef struct platform_thread {
+    void* internal_data;
+    u64 thread_id;
+} platform_thread;
+
+typedef struct platform_semaphore {
+    void* internal_data;
+} platform_semaphore;
+
+typedef struct platform_mutex {
+    void* internal_data;
+} platform_mutex;
+
+TAPI b8 platform_thread_create(PFN_thread_start start, void* param, platform_thread* out_thread);
+// Blocks until the thread exits, then releases its handle.
+TAPI void platform_thread_join(platform_thread* thread);
+u64 platform_get_thread_id();
+TAPI u32 platform_get_processor_count();
+
+// Not recursive. Blocked threads sleep instead of spinning.
+TAPI b8 platform_mutex_create(platform_mutex* out_mutex);
+TAPI void platform_mutex_destroy(platform_mutex* mutex);
+TAPI void platform_mutex_lock(platform_mutex* mutex);
+TAPI void platform_mutex_unlock(platform_mutex* mutex);
+
+b8 platform_semaphore_create(u32 initial_count, u32 max_count, platform_semaphore* out_semaphore);
+void platform_semaphore_destroy(platform_semaphore* semaphore);
+void platform_semaphore_signal(platform_semaphore* semaphore, u32 count);
+void platform_semaphore_wait(platform_semaphore* semaphore);
+// Returns FALSE if timeout_ms passed without a signal.
+b8 platform_semaphore_wait_timeout(platform_semaphore* semaphore, u32 timeout_ms);
+
+typedef struct platform_file {
+    void* internal_data;
+} platform_file;
+
+// Opens path for writing, creating it if needed. With append FALSE an
+// existing file is truncated. Writes are unbuffered, callers batch them.
+b8 platform_file_open(const char* path, b8 append, platform_file* out_file);
+void platform_file_close(platform_file* file);
+b8 platform_file_write(platform_file* file, const void* data, u64 size);
+u64 platform_file_size(platform_file* file);
+// Replaces to if it exists.
+b8 platform_file_rename(const char* from, const char* to);
+b8 platform_file_delete(const char* path);
+
+// Entry points must never return; switch to another fiber instead.
+typedef void (*PFN_fiber_entry)(void* param);
+
+typedef struct platform_fiber {
+    void* internal_data;
+} platform_fiber;
+
+// A thread has to become a fiber before it can switch to other fibers.
+b8 platform_fiber_convert_thread(platform_fiber* out_fiber);
+void platform_fiber_revert_thread(platform_fiber* fiber);
+// TRUE when fibers run on stack_memory supplied by the caller, FALSE when
+// the OS allocates the stack itself and stack_memory is ignored.
+b8 platform_fiber_requires_stack_memory();
+b8 platform_fiber_create(u64 stack_size, void* stack_memory, PFN_fiber_entry entry, void* param, platform_fiber* out_fiber);
+void platform_fiber_destroy(platform_fiber* fiber);
+// Saves the running context into from and resumes to.
+void platform_fiber_switch(platform_fiber* from, platform_fiber* to);
\ No newline at end of file
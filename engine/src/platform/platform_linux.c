@@ -0,0 +1,377 @@
+#include "platform/platform.h"
+
+#if TPLATFORM_LINUX
+
+#include "core/logger.h"
+#include "renderer/vulkan/vulkan_platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <ucontext.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// Headless: there is no window, so the platform layer only provides what
+// the engine core needs to run and be tested without a display.
+
+typedef struct linux_thread_start {
+    PFN_thread_start start;
+    void* param;
+} linux_thread_start;
+
+typedef struct linux_fiber {
+    ucontext_t context;
+    PFN_fiber_entry entry;
+    void* param;
+} linux_fiber;
+
+b8 platform_startup(
+    platform_state* plat_state,
+    const char* application_name,
+    i32 x,
+    i32 y,
+    i32 width,
+    i32 height)
+{
+    plat_state->internal_state = 0;
+    return TRUE;
+}
+
+void platform_shutdown(platform_state* plat_state) {
+}
+
+b8 platform_pump_messages(platform_state* plat_state) {
+    return TRUE;
+}
+
+void* platform_allocate(u64 size, u16 alignment) {
+    if(alignment > 1) {
+        void* block = 0;
+        if(posix_memalign(&block, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) != 0) {
+            return 0;
+        }
+        return block;
+    }
+    return malloc(size);
+}
+
+void platform_free(void* block, u16 alignment) {
+    free(block);
+}
+
+void* platform_reallocate(void* block, u64 size, u16 alignment) {
+    if(alignment > 1) {
+        // realloc does not keep the alignment, so move by hand.
+        void* result = platform_allocate(size, alignment);
+        if(result && block) {
+            u64 old_size = malloc_usable_size(block);
+            memcpy(result, block, old_size < size ? old_size : size);
+            free(block);
+        }
+        return result;
+    }
+    return realloc(block, size);
+}
+
+void* platform_zero_memory(void* block, u64 size) {
+    return memset(block, 0, size);
+}
+
+void* platform_copy_memory(void* dest, const void* source, u64 size) {
+    return memcpy(dest, source, size);
+}
+
+void* platform_move_memory(void* dest, const void* source, u64 size) {
+    return memmove(dest, source, size);
+}
+
+void* platform_set_memory(void* dest, i32 value, u64 size) {
+    return memset(dest, value, size);
+}
+
+void platform_console_write(const char* message, u8 color) {
+    // FATAL, ERROR, WARN, INFO, DEBUG, TRACE
+    static const char* colour_strings[6] = {"0;41", "1;31", "1;33", "1;32", "1;34", "1;30"};
+    printf("\033[%sm%s\033[0m", colour_strings[color], message);
+}
+
+void platform_console_write_error(const char* message, u8 color) {
+    static const char* colour_strings[6] = {"0;41", "1;31", "1;33", "1;32", "1;34", "1;30"};
+    fprintf(stderr, "\033[%sm%s\033[0m", colour_strings[color], message);
+}
+
+f64 platform_get_absolute_time() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 0.000000001;
+}
+
+void platform_sleep(u64 ms) {
+    if(ms == 0) {
+        sched_yield();
+        return;
+    }
+
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000 * 1000;
+    nanosleep(&ts, 0);
+}
+
+static void* linux_thread_main(void* param) {
+    linux_thread_start start = *(linux_thread_start*)param;
+    free(param);
+    return (void*)(u64)start.start(start.param);
+}
+
+b8 platform_thread_create(PFN_thread_start start, void* param, platform_thread* out_thread) {
+    pthread_t* thread = malloc(sizeof(pthread_t));
+    linux_thread_start* thread_start = malloc(sizeof(linux_thread_start));
+    if(!thread || !thread_start) {
+        TERROR("platform_thread_create failed to allocate a thread.");
+        free(thread_start);
+        free(thread);
+        return FALSE;
+    }
+    thread_start->start = start;
+    thread_start->param = param;
+
+    i32 result = pthread_create(thread, 0, linux_thread_main, thread_start);
+    if(result != 0) {
+        TERROR("pthread_create failed with error %i.", result);
+        free(thread_start);
+        free(thread);
+        return FALSE;
+    }
+
+    out_thread->internal_data = thread;
+    out_thread->thread_id = (u64)*thread;
+    return TRUE;
+}
+
+void platform_thread_join(platform_thread* thread) {
+    if(thread->internal_data) {
+        pthread_join(*(pthread_t*)thread->internal_data, 0);
+        free(thread->internal_data);
+        thread->internal_data = 0;
+    }
+}
+
+// The pthread_t, so it matches platform_thread.thread_id.
+u64 platform_get_thread_id() {
+    return (u64)pthread_self();
+}
+
+u32 platform_get_processor_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+b8 platform_mutex_create(platform_mutex* out_mutex) {
+    pthread_mutex_t* mutex = malloc(sizeof(pthread_mutex_t));
+    i32 result = pthread_mutex_init(mutex, 0);
+    if(result != 0) {
+        TERROR("pthread_mutex_init failed with error %i.", result);
+        free(mutex);
+        return FALSE;
+    }
+
+    out_mutex->internal_data = mutex;
+    return TRUE;
+}
+
+void platform_mutex_destroy(platform_mutex* mutex) {
+    if(mutex->internal_data) {
+        pthread_mutex_destroy((pthread_mutex_t*)mutex->internal_data);
+        free(mutex->internal_data);
+        mutex->internal_data = 0;
+    }
+}
+
+void platform_mutex_lock(platform_mutex* mutex) {
+    pthread_mutex_lock((pthread_mutex_t*)mutex->internal_data);
+}
+
+void platform_mutex_unlock(platform_mutex* mutex) {
+    pthread_mutex_unlock((pthread_mutex_t*)mutex->internal_data);
+}
+
+b8 platform_semaphore_create(u32 initial_count, u32 max_count, platform_semaphore* out_semaphore) {
+    sem_t* semaphore = malloc(sizeof(sem_t));
+    if(sem_init(semaphore, 0, initial_count) != 0) {
+        TERROR("sem_init failed with error %i.", errno);
+        free(semaphore);
+        return FALSE;
+    }
+
+    out_semaphore->internal_data = semaphore;
+    return TRUE;
+}
+
+void platform_semaphore_destroy(platform_semaphore* semaphore) {
+    if(semaphore->internal_data) {
+        sem_destroy((sem_t*)semaphore->internal_data);
+        free(semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platform_semaphore_signal(platform_semaphore* semaphore, u32 count) {
+    for(u32 i = 0; i < count; ++i) {
+        sem_post((sem_t*)semaphore->internal_data);
+    }
+}
+
+void platform_semaphore_wait(platform_semaphore* semaphore) {
+    while(sem_wait((sem_t*)semaphore->internal_data) != 0 && errno == EINTR) {
+    }
+}
+
+b8 platform_semaphore_wait_timeout(platform_semaphore* semaphore, u32 timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000 * 1000;
+    if(deadline.tv_nsec >= 1000 * 1000 * 1000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+
+    for(;;) {
+        if(sem_timedwait((sem_t*)semaphore->internal_data, &deadline) == 0) {
+            return TRUE;
+        }
+        if(errno != EINTR) {
+            return FALSE;
+        }
+    }
+}
+
+b8 platform_file_open(const char* path, b8 append, platform_file* out_file) {
+    i32 fd = open(path, O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+    if(fd < 0) {
+        return FALSE;
+    }
+
+    // Stored offset by one so that 0 still means closed.
+    out_file->internal_data = (void*)(u64)(fd + 1);
+    return TRUE;
+}
+
+void platform_file_close(platform_file* file) {
+    if(file->internal_data) {
+        close((i32)(u64)file->internal_data - 1);
+        file->internal_data = 0;
+    }
+}
+
+b8 platform_file_write(platform_file* file, const void* data, u64 size) {
+    i32 fd = (i32)(u64)file->internal_data - 1;
+    const u8* bytes = data;
+    while(size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if(written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return FALSE;
+        }
+        bytes += written;
+        size -= (u64)written;
+    }
+    return TRUE;
+}
+
+u64 platform_file_size(platform_file* file) {
+    struct stat info;
+    if(fstat((i32)(u64)file->internal_data - 1, &info) != 0) {
+        return 0;
+    }
+    return (u64)info.st_size;
+}
+
+b8 platform_file_rename(const char* from, const char* to) {
+    return rename(from, to) == 0;
+}
+
+b8 platform_file_delete(const char* path) {
+    return unlink(path) == 0;
+}
+
+b8 platform_fiber_convert_thread(platform_fiber* out_fiber) {
+    out_fiber->internal_data = calloc(1, sizeof(linux_fiber));
+    return out_fiber->internal_data != 0;
+}
+
+void platform_fiber_revert_thread(platform_fiber* fiber) {
+    free(fiber->internal_data);
+    fiber->internal_data = 0;
+}
+
+b8 platform_fiber_requires_stack_memory() {
+    return TRUE;
+}
+
+// makecontext only passes int arguments, so the fiber pointer is split.
+static void linux_fiber_main(u32 low, u32 high) {
+    linux_fiber* fiber = (linux_fiber*)(((u64)high << 32) | (u64)low);
+    fiber->entry(fiber->param);
+    TFATAL("A fiber entry point returned.");
+    abort();
+}
+
+b8 platform_fiber_create(u64 stack_size, void* stack_memory, PFN_fiber_entry entry, void* param, platform_fiber* out_fiber) {
+    if(!stack_memory) {
+        TERROR("platform_fiber_create requires stack memory on this platform.");
+        return FALSE;
+    }
+
+    linux_fiber* fiber = calloc(1, sizeof(linux_fiber));
+    if(!fiber) {
+        TERROR("platform_fiber_create failed to allocate a fiber.");
+        return FALSE;
+    }
+    if(getcontext(&fiber->context) != 0) {
+        TERROR("getcontext failed with error %i.", errno);
+        free(fiber);
+        return FALSE;
+    }
+
+    fiber->entry = entry;
+    fiber->param = param;
+    fiber->context.uc_stack.ss_sp = stack_memory;
+    fiber->context.uc_stack.ss_size = stack_size;
+    fiber->context.uc_link = 0;
+    u64 address = (u64)fiber;
+    makecontext(&fiber->context, (void (*)())linux_fiber_main, 2, (u32)address, (u32)(address >> 32));
+
+    out_fiber->internal_data = fiber;
+    return TRUE;
+}
+
+void platform_fiber_destroy(platform_fiber* fiber) {
+    free(fiber->internal_data);
+    fiber->internal_data = 0;
+}
+
+void platform_fiber_switch(platform_fiber* from, platform_fiber* to) {
+    swapcontext(&((linux_fiber*)from->internal_data)->context, &((linux_fiber*)to->internal_data)->context);
+}
+
+void platform_get_required_extension_names(const char*** names_darray) {
+}
+
+b8 platform_create_vulkan_surface(struct platform_state* plat_state, struct vulkan_context* context) {
+    TERROR("Vulkan surfaces are not supported by the headless Linux platform.");
+    return FALSE;
+}
+
+#endif
\ No newline at end of file
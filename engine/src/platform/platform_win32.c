@@ -11,6 +11,7 @@
 #include <windows.h>
 #include <windowsx.h>
 #include <stdlib.h>
+#include <malloc.h>
 
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_win32.h>
@@ -131,12 +132,26 @@ b8 platform_pump_messages(platform_state* plat_state) {
     return TRUE;
 }
 
-void* platform_allocate(u64 size, b8 aligned) {
+void* platform_allocate(u64 size, u16 alignment) {
+    if(alignment > 1) {
+        return _aligned_malloc(size, alignment);
+    }
     return malloc(size);
 }
 
-void platform_free(void* block, b8 aligned) {
-    free(block);
+void platform_free(void* block, u16 alignment) {
+    if(alignment > 1) {
+        _aligned_free(block);
+    } else {
+        free(block);
+    }
+}
+
+void* platform_reallocate(void* block, u64 size, u16 alignment) {
+    if(alignment > 1) {
+        return _aligned_realloc(block, size, alignment);
+    }
+    return realloc(block, size);
 }
 
 void* platform_zero_memory(void* block, u64 size) {
@@ -147,6 +162,10 @@ void* platform_copy_memory(void* dest, const void* source, u64 size) {
     return memcpy(dest, source, size);
 }
 
+void* platform_move_memory(void* dest, const void* source, u64 size) {
+    return memmove(dest, source, size);
+}
+
 void *platform_set_memory(void *dest, i32 value, u64 size) {
     return memset(dest, value, size);
 }
@@ -185,6 +204,172 @@ void platform_sleep(u64 ms) {
     Sleep(ms);
 }
 
+b8 platform_thread_create(PFN_thread_start start, void* param, platform_thread* out_thread) {
+    DWORD thread_id;
+    HANDLE handle = CreateThread(0, 0, (LPTHREAD_START_ROUTINE)start, param, 0, &thread_id);
+    if(!handle) {
+        TERROR("CreateThread failed with error %u.", GetLastError());
+        return FALSE;
+    }
+
+    out_thread->internal_data = handle;
+    out_thread->thread_id = thread_id;
+    return TRUE;
+}
+
+void platform_thread_join(platform_thread* thread) {
+    if(thread->internal_data) {
+        WaitForSingleObject((HANDLE)thread->internal_data, INFINITE);
+        CloseHandle((HANDLE)thread->internal_data);
+        thread->internal_data = 0;
+    }
+}
+
+u64 platform_get_thread_id() {
+    return (u64)GetCurrentThreadId();
+}
+
+u32 platform_get_processor_count() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (u32)info.dwNumberOfProcessors;
+}
+
+// An SRWLOCK is pointer-sized and starts out zeroed, so it lives in
+// internal_data itself.
+b8 platform_mutex_create(platform_mutex* out_mutex) {
+    InitializeSRWLock((PSRWLOCK)&out_mutex->internal_data);
+    return TRUE;
+}
+
+void platform_mutex_destroy(platform_mutex* mutex) {
+    mutex->internal_data = 0;
+}
+
+void platform_mutex_lock(platform_mutex* mutex) {
+    AcquireSRWLockExclusive((PSRWLOCK)&mutex->internal_data);
+}
+
+void platform_mutex_unlock(platform_mutex* mutex) {
+    ReleaseSRWLockExclusive((PSRWLOCK)&mutex->internal_data);
+}
+
+b8 platform_semaphore_create(u32 initial_count, u32 max_count, platform_semaphore* out_semaphore) {
+    HANDLE handle = CreateSemaphoreA(0, (LONG)initial_count, (LONG)max_count, 0);
+    if(!handle) {
+        TERROR("CreateSemaphore failed with error %u.", GetLastError());
+        return FALSE;
+    }
+
+    out_semaphore->internal_data = handle;
+    return TRUE;
+}
+
+void platform_semaphore_destroy(platform_semaphore* semaphore) {
+    if(semaphore->internal_data) {
+        CloseHandle((HANDLE)semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platform_semaphore_signal(platform_semaphore* semaphore, u32 count) {
+    ReleaseSemaphore((HANDLE)semaphore->internal_data, (LONG)count, 0);
+}
+
+void platform_semaphore_wait(platform_semaphore* semaphore) {
+    WaitForSingleObject((HANDLE)semaphore->internal_data, INFINITE);
+}
+
+b8 platform_semaphore_wait_timeout(platform_semaphore* semaphore, u32 timeout_ms) {
+    return WaitForSingleObject((HANDLE)semaphore->internal_data, timeout_ms) == WAIT_OBJECT_0;
+}
+
+b8 platform_file_open(const char* path, b8 append, platform_file* out_file) {
+    HANDLE handle = CreateFileA(path, append ? FILE_APPEND_DATA : GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, 0,
+                                append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if(handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    out_file->internal_data = handle;
+    return TRUE;
+}
+
+void platform_file_close(platform_file* file) {
+    if(file->internal_data) {
+        CloseHandle((HANDLE)file->internal_data);
+        file->internal_data = 0;
+    }
+}
+
+b8 platform_file_write(platform_file* file, const void* data, u64 size) {
+    const u8* bytes = data;
+    while(size > 0) {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        DWORD written = 0;
+        if(!WriteFile((HANDLE)file->internal_data, bytes, chunk, &written, 0)) {
+            return FALSE;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return TRUE;
+}
+
+u64 platform_file_size(platform_file* file) {
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx((HANDLE)file->internal_data, &size)) {
+        return 0;
+    }
+    return (u64)size.QuadPart;
+}
+
+b8 platform_file_rename(const char* from, const char* to) {
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+b8 platform_file_delete(const char* path) {
+    return DeleteFileA(path) != 0;
+}
+
+b8 platform_fiber_convert_thread(platform_fiber* out_fiber) {
+    out_fiber->internal_data = ConvertThreadToFiber(0);
+    if(!out_fiber->internal_data) {
+        TERROR("ConvertThreadToFiber failed with error %u.", GetLastError());
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void platform_fiber_revert_thread(platform_fiber* fiber) {
+    ConvertFiberToThread();
+    fiber->internal_data = 0;
+}
+
+b8 platform_fiber_requires_stack_memory() {
+    return FALSE;
+}
+
+b8 platform_fiber_create(u64 stack_size, void* stack_memory, PFN_fiber_entry entry, void* param, platform_fiber* out_fiber) {
+    out_fiber->internal_data = CreateFiberEx(stack_size, stack_size, 0, (LPFIBER_START_ROUTINE)entry, param);
+    if(!out_fiber->internal_data) {
+        TERROR("CreateFiberEx failed with error %u.", GetLastError());
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void platform_fiber_destroy(platform_fiber* fiber) {
+    if(fiber->internal_data) {
+        DeleteFiber(fiber->internal_data);
+        fiber->internal_data = 0;
+    }
+}
+
+void platform_fiber_switch(platform_fiber* from, platform_fiber* to) {
+    SwitchToFiber(to->internal_data);
+}
+
 void platform_get_required_extension_names(const char*** names_darray) {
     darray_push(*names_darray, &"VK_KHR_win32_surface");
 }
@@ -213,7 +398,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
             return 1;
         case WM_CLOSE:
             event_context data = {};
-            event_fire(EVENT_CODE_APPLICATION_QUIT, 0, data);
+            event_post(EVENT_CODE_APPLICATION_QUIT, 0, data);
             return TRUE;
         case WM_DESTROY:
             PostQuitMessage(0);
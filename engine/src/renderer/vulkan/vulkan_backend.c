@@ -15,6 +15,7 @@
 #include "core/tstring.h"
 
 #include "containers/darray.h"
+#include "containers/hashtable.h"
 
 #include "platform/platform.h"
 
@@ -71,7 +72,7 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* app
     TDEBUG("Required extensions:");
     u32 length = darray_length(required_extensions);
     for(u32 i = 0; i < length; ++i) {
-        TDEBUG(required_extensions[i]);
+        TDEBUG("%s", required_extensions[i]);
     }
 #endif
 
@@ -92,22 +93,27 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const char* app
     VkLayerProperties* available_layers = darray_reserve(VkLayerProperties, available_layer_count);
     VK_CHECK(vkEnumerateInstanceLayerProperties(&available_layer_count, available_layers));
 
+    hashtable available_layer_set;
+    b8 layer_set_built = hashtable_create(0, available_layer_count, HASHTABLE_KEY_STRING, &available_layer_set);
+    for(u32 j = 0; layer_set_built && j < available_layer_count; ++j) {
+        layer_set_built = hashtable_set(&available_layer_set, available_layers[j].layerName, 0);
+    }
+    if(!layer_set_built) {
+        TFATAL("Failed to allocate the lookup table for %u validation layers.", available_layer_count);
+        hashtable_destroy(&available_layer_set);
+        return FALSE;
+    }
+
     for(u32 i = 0; i < required_validation_layer_count; ++i) {
         TINFO("Searching for layer: %s...", required_validation_layer_names[i]);
-        b8 found = FALSE;
-        for(u32 j = 0; j < available_layer_count; ++j) {
-            if(strings_equal(required_validation_layer_names[i], available_layers[j].layerName)) {
-                found = TRUE;
-                TINFO("Found layer: %s", required_validation_layer_names[i]);
-                break;
-            }
-        }
-
-        if(!found) {
+        if(!hashtable_contains(&available_layer_set, required_validation_layer_names[i])) {
             TFATAL("Required validation layer is missing: %s", required_validation_layer_names[i]);
+            hashtable_destroy(&available_layer_set);
             return FALSE;
         }
+        TINFO("Found layer: %s", required_validation_layer_names[i]);
     }
+    hashtable_destroy(&available_layer_set);
     TINFO("All required validation layers are present.");
 #endif
     create_info.enabledLayerCount = required_validation_layer_count;
@@ -283,16 +289,16 @@ VKAPI_ATTR VkBool32 VKAPI_CALL vk_debug_callback(
     switch(message_severity) {
         default:
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-            TERROR(callback_data->pMessage);
+            TERROR("%s", callback_data->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-            TWARN(callback_data->pMessage);
+            TWARN("%s", callback_data->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-            TINFO(callback_data->pMessage);
+            TINFO("%s", callback_data->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-            TTRACE(callback_data->pMessage);
+            TTRACE("%s", callback_data->pMessage);
             break;
     }
     return VK_FALSE;
@@ -3,6 +3,7 @@
 #include "core/tstring.h"
 #include "core/tmemory.h"
 #include "containers/darray.h"
+#include "containers/hashtable.h"
 #include "vulkan_types.inl"
 
 typedef struct vulkan_physical_device_requirements {
@@ -423,24 +424,32 @@ b8 physical_device_meets_requirements(
                     available_extension_count, MEMORY_TAG_RENDERER);
                 VK_CHECK(vkEnumerateDeviceExtensionProperties(device, 0, &available_extension_count, available_extensions));
 
+                hashtable available_extension_set;
+                b8 extension_set_built = hashtable_create(0, available_extension_count, HASHTABLE_KEY_STRING, &available_extension_set);
+                for(u32 j = 0; extension_set_built && j < available_extension_count; ++j) {
+                    extension_set_built = hashtable_set(&available_extension_set, available_extensions[j].extensionName, 0);
+                }
+                if(!extension_set_built) {
+                    TERROR("Failed to allocate the lookup table for %u device extensions, skipping device.",
+                        available_extension_count);
+                    hashtable_destroy(&available_extension_set);
+                    tfree(available_extensions, sizeof(VkExtensionProperties) *
+                        available_extension_count, MEMORY_TAG_RENDERER);
+                    return FALSE;
+                }
+
                 u32 required_extension_count = darray_length(requirements->device_extension_names);
                 for(u32 i = 0; i < required_extension_count; ++i) {
-                    b8 found = FALSE;
-                    for(u32 j = 0; j < available_extension_count; ++j) {
-                        if(strings_equal(requirements->device_extension_names[i], available_extensions[j].extensionName)) {
-                            found = TRUE;
-                            break;
-                        }
-                    }
-
-                    if(!found) {
+                    if(!hashtable_contains(&available_extension_set, requirements->device_extension_names[i])) {
                         TINFO("Required extension not found: '%s', skipping device.",
                             requirements->device_extension_names[i]);
+                        hashtable_destroy(&available_extension_set);
                         tfree(available_extensions, sizeof(VkExtensionProperties) *
                             available_extension_count, MEMORY_TAG_RENDERER);
                         return FALSE;
                     }
                 }
+                hashtable_destroy(&available_extension_set);
             }
             tfree(available_extensions, sizeof(VkExtensionProperties) * available_extension_count, MEMORY_TAG_RENDERER);
         }
@@ -0,0 +1,201 @@
+// Registers and unregisters listeners while other threads fire nested
+// events, then checks that every replaced listener list is freed by
+// event_reclaim_snapshots even though firing never stops, and that no
+// dispatch saw a broken list:
+// event_stress [firers] [registrars] [milliseconds] [nesting]
+//
+// A nesting deep enough that firers * nesting exceeds the engine's 64
+// dispatch slots also runs the overflow fallback.
+
+#include <defines.h>
+#include <core/event.h>
+#include <core/tmemory.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_THREADS 64
+#define MAX_NESTING 64
+#define INSTANCES_PER_REGISTRAR 8
+// Clear of the engine's codes, which stop at MAX_EVENT_CODE.
+#define CODE_CHAIN_FIRST 0x1000
+#define CHURN_MAGIC 0xC0FFEE11u
+
+typedef struct churn_instance {
+    volatile u32 magic;
+} churn_instance;
+
+typedef struct stress_state {
+    volatile b8 firing;
+    volatile b8 churning;
+    // Levels fired per top-level fire. Dropped to 1 once churning stops so
+    // that dispatches fit the slots and reclaiming is not held back.
+    volatile u32 nesting;
+    volatile u64 fires;
+    // Calls of the permanent listener on the first level, which has to see
+    // every fire.
+    volatile u64 first_level_calls;
+    // Listener instances that did not look like one.
+    volatile u64 bad_instances;
+    churn_instance instances[MAX_THREADS][INSTANCES_PER_REGISTRAR];
+} stress_state;
+
+static stress_state state;
+
+static b8 chain_listener(u16 code, void* sender, void* listener_inst, event_context data) {
+    u32 level = code - CODE_CHAIN_FIRST;
+    if(level == 0) {
+        __atomic_fetch_add(&state.first_level_calls, 1, __ATOMIC_RELAXED);
+    }
+    if(level + 1 < __atomic_load_n(&state.nesting, __ATOMIC_RELAXED)) {
+        event_fire(code + 1, sender, data);
+    }
+    return FALSE;
+}
+
+static b8 churn_listener(u16 code, void* sender, void* listener_inst, event_context data) {
+    if(((churn_instance*)listener_inst)->magic != CHURN_MAGIC) {
+        __atomic_fetch_add(&state.bad_instances, 1, __ATOMIC_RELAXED);
+    }
+    return FALSE;
+}
+
+// Unregisters itself from inside the dispatch that calls it.
+static b8 self_removing_listener(u16 code, void* sender, void* listener_inst, event_context data) {
+    churn_listener(code, sender, listener_inst, data);
+    event_unregister(code, listener_inst, self_removing_listener);
+    return FALSE;
+}
+
+static u32 firer_main(void* param) {
+    event_context context = {};
+    while(__atomic_load_n(&state.firing, __ATOMIC_ACQUIRE)) {
+        event_fire(CODE_CHAIN_FIRST, 0, context);
+        __atomic_fetch_add(&state.fires, 1, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+static u32 registrar_main(void* param) {
+    churn_instance* instances = state.instances[(u64)param];
+    u32 round = 0;
+    while(__atomic_load_n(&state.churning, __ATOMIC_ACQUIRE)) {
+        u32 nesting = __atomic_load_n(&state.nesting, __ATOMIC_RELAXED);
+        for(u32 i = 0; i < INSTANCES_PER_REGISTRAR - 1; ++i) {
+            event_register(CODE_CHAIN_FIRST + (round + i) % nesting, &instances[i], churn_listener);
+        }
+        event_register(CODE_CHAIN_FIRST + round % nesting, &instances[INSTANCES_PER_REGISTRAR - 1], self_removing_listener);
+        platform_sleep(0);
+        for(u32 i = 0; i < INSTANCES_PER_REGISTRAR - 1; ++i) {
+            event_unregister(CODE_CHAIN_FIRST + (round + i) % nesting, &instances[i], churn_listener);
+        }
+        // Usually gone already, unless nothing fired that code meanwhile.
+        event_unregister(CODE_CHAIN_FIRST + round % nesting, &instances[INSTANCES_PER_REGISTRAR - 1], self_removing_listener);
+        ++round;
+    }
+    return 0;
+}
+
+static u64 live_event_allocations() {
+    memory_stats stats;
+    get_memory_stats(&stats);
+    return stats.tags[MEMORY_TAG_EVENT].live_allocations;
+}
+
+int main(int argc, char** argv) {
+    u32 firers = argc > 1 ? (u32)strtoul(argv[1], 0, 10) : 4;
+    u32 registrars = argc > 2 ? (u32)strtoul(argv[2], 0, 10) : 2;
+    u32 duration_ms = argc > 3 ? (u32)strtoul(argv[3], 0, 10) : 2000;
+    u32 nesting = argc > 4 ? (u32)strtoul(argv[4], 0, 10) : 24;
+    if(firers == 0 || registrars == 0 || firers + registrars > MAX_THREADS || nesting == 0 || nesting > MAX_NESTING) {
+        fprintf(stderr, "Usage: %s [firers] [registrars] [milliseconds] [nesting]\n", argv[0]);
+        return 1;
+    }
+
+    memory_system_config memory_config = {};
+    memory_config.total_alloc_size = MEMORY_HEAP_SIZE;
+    memory_config.fit = DYNAMIC_ALLOCATOR_FIT_FIRST;
+    memory_config.frame_arena_size = MEMORY_FRAME_ARENA_SIZE;
+    if(!initialize_memory(memory_config) || !event_initialize()) {
+        return 1;
+    }
+
+    for(u32 t = 0; t < registrars; ++t) {
+        for(u32 i = 0; i < INSTANCES_PER_REGISTRAR; ++i) {
+            state.instances[t][i].magic = CHURN_MAGIC;
+        }
+    }
+    for(u32 level = 0; level < nesting; ++level) {
+        event_register(CODE_CHAIN_FIRST + level, 0, chain_listener);
+    }
+    u64 baseline = live_event_allocations();
+
+    printf("%u firers, %u registrars, %u levels of nesting, %ums\n", firers, registrars, nesting, duration_ms);
+    state.nesting = nesting;
+    state.firing = TRUE;
+    state.churning = TRUE;
+    platform_thread threads[MAX_THREADS];
+    for(u32 i = 0; i < firers + registrars; ++i) {
+        b8 started = i < firers ? platform_thread_create(firer_main, 0, &threads[i])
+                                : platform_thread_create(registrar_main, (void*)(u64)(i - firers), &threads[i]);
+        if(!started) {
+            return 1;
+        }
+    }
+
+    // Reclaim the way the application does between frames.
+    u64 peak = 0;
+    f64 start = platform_get_absolute_time();
+    while((platform_get_absolute_time() - start) * 1000.0 < duration_ms) {
+        event_reclaim_snapshots();
+        u64 live = live_event_allocations();
+        if(live > peak) {
+            peak = live;
+        }
+        platform_sleep(1);
+    }
+
+    __atomic_store_n(&state.churning, FALSE, __ATOMIC_RELEASE);
+    for(u32 i = firers; i < firers + registrars; ++i) {
+        platform_thread_join(&threads[i]);
+    }
+
+    // Firing goes on: every retired list must still be freed.
+    __atomic_store_n(&state.nesting, 1, __ATOMIC_RELAXED);
+    u64 live = 0;
+    start = platform_get_absolute_time();
+    do {
+        event_reclaim_snapshots();
+        live = live_event_allocations();
+        platform_sleep(1);
+    } while(live > baseline && platform_get_absolute_time() - start < 2.0);
+
+    __atomic_store_n(&state.firing, FALSE, __ATOMIC_RELEASE);
+    for(u32 i = 0; i < firers; ++i) {
+        platform_thread_join(&threads[i]);
+    }
+
+    printf("%llu fires, peak of %llu event allocations, %llu at the start\n", state.fires, peak, baseline);
+    b8 failed = FALSE;
+    if(live > baseline) {
+        printf("FAILED: %llu replaced listener lists were never freed while firing continued\n", live - baseline);
+        failed = TRUE;
+    }
+    if(state.first_level_calls != state.fires) {
+        printf("FAILED: %llu fires reached the permanent listener %llu times\n", state.fires, state.first_level_calls);
+        failed = TRUE;
+    }
+    if(state.bad_instances) {
+        printf("FAILED: %llu calls got a broken listener instance\n", state.bad_instances);
+        failed = TRUE;
+    }
+
+    event_shutdown();
+    shutdown_memory();
+    if(failed) {
+        return 2;
+    }
+    printf("Every replaced listener list was freed and every dispatch saw a valid one.\n");
+    return 0;
+}
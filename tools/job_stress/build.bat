@@ -0,0 +1,16 @@
+@ECHO OFF
+SetLocal EnableDelayedExpansion
+
+SET cFilenames =
+FOR /R %%f in (*.c) do (
+    SET cFilenames=!cFilenames! %%f
+)
+
+SET assembly=job_stress
+SET compilerFlags=-g
+SET includeFlags=-Isrc -I../../engine/src
+SET linkerFlags=-L../../bin/ -lengine.lib
+SET defines=-D_DEBUG -DTIMPORT -D_CRT_SECURE_NO_WARNINGS
+
+ECHO "Building %assembly%..."
+clang %cFilenames% %compilerFlags% -o ../../bin/%assembly%.exe %defines% %includeFlags% %linkerFlags%
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Linux build of job_stress, for running it headless. There is no engine
+# library build on Linux, so the engine sources it needs are compiled in.
+# CC picks the compiler and CFLAGS adds flags, e.g.
+# CFLAGS=-fsanitize=thread ./build.sh
+set -e
+
+assembly=job_stress
+engine=../../engine/src
+cFilenames="src/main.c $engine/containers/*.c $engine/memory/*.c $engine/platform/platform_linux.c"
+for f in $engine/core/*.c; do
+    # application.c pulls in the renderer.
+    if [ "$(basename "$f")" != "application.c" ]; then
+        cFilenames="$cFilenames $f"
+    fi
+done
+
+echo "Building $assembly..."
+mkdir -p ../../bin
+${CC:-gcc} $cFilenames -g -D_DEBUG -D__gcc__ -Isrc -I$engine $CFLAGS -o ../../bin/$assembly -lpthread
@@ -0,0 +1,216 @@
+// Runs nested jobs that wait on their children and checks that every wait
+// returns only after its jobs finished, that job_submit_after holds jobs
+// back until their dependency is done and that each leaf runs exactly
+// once. Waiting parks fibers, so each pass uses a different fiber count,
+// including counts small enough to run out:
+// job_stress [workers] [rounds] [fiber count]
+
+#include <defines.h>
+#include <core/job_system.h>
+#include <core/tmemory.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ROOT_JOBS 4
+#define BRANCH_JOBS 8
+#define LEAF_JOBS 16
+#define LEAVES_PER_ROUND (ROOT_JOBS * BRANCH_JOBS * LEAF_JOBS)
+
+// Used when no fiber count is given. 0 waits without fibers.
+static const u32 fiber_counts[] = {0, 1, 2, 3, 4, JOB_SYSTEM_FIBER_COUNT};
+#define FIBER_COUNT_COUNT (sizeof(fiber_counts) / sizeof(fiber_counts[0]))
+
+struct root_job;
+
+typedef struct branch_job {
+    struct root_job* root;
+    u64 first_leaf;
+    // Submitted with job_submit_after behind the first half.
+    b8 second_half;
+    volatile i32 leaves_done;
+} branch_job;
+
+typedef struct leaf_job {
+    branch_job* branch;
+    u64 index;
+} leaf_job;
+
+typedef struct root_job {
+    branch_job branches[BRANCH_JOBS];
+    volatile i32 branches_done;
+    volatile i32 first_half_done;
+} root_job;
+
+typedef struct stress_results {
+    // How often each leaf of the current pass ran; every entry must end up
+    // at 1.
+    volatile u32* leaf_runs;
+    // Waits that returned before all of their jobs had finished.
+    volatile u64 early_returns;
+    // Jobs that started before the jobs they were submitted after.
+    volatile u64 early_starts;
+} stress_results;
+
+static stress_results results;
+
+static void leaf_main(void* param) {
+    leaf_job* leaf = param;
+    __atomic_fetch_add(&results.leaf_runs[leaf->index], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&leaf->branch->leaves_done, 1, __ATOMIC_RELEASE);
+}
+
+static void branch_main(void* param) {
+    branch_job* branch = param;
+    if(branch->second_half && __atomic_load_n(&branch->root->first_half_done, __ATOMIC_ACQUIRE) != BRANCH_JOBS / 2) {
+        __atomic_fetch_add(&results.early_starts, 1, __ATOMIC_RELAXED);
+    }
+
+    leaf_job leaves[LEAF_JOBS];
+    job_decl jobs[LEAF_JOBS];
+    for(u32 i = 0; i < LEAF_JOBS; ++i) {
+        leaves[i].branch = branch;
+        leaves[i].index = branch->first_leaf + i;
+        jobs[i].entry = leaf_main;
+        jobs[i].param = &leaves[i];
+    }
+
+    job_counter counter = {};
+    job_submit(jobs, LEAF_JOBS, &counter);
+    job_wait(&counter);
+    if(__atomic_load_n(&branch->leaves_done, __ATOMIC_ACQUIRE) != LEAF_JOBS) {
+        __atomic_fetch_add(&results.early_returns, 1, __ATOMIC_RELAXED);
+    }
+
+    if(!branch->second_half) {
+        __atomic_fetch_add(&branch->root->first_half_done, 1, __ATOMIC_RELEASE);
+    }
+    __atomic_fetch_add(&branch->root->branches_done, 1, __ATOMIC_RELEASE);
+}
+
+static void root_main(void* param) {
+    root_job* root = param;
+    job_decl jobs[BRANCH_JOBS];
+    for(u32 i = 0; i < BRANCH_JOBS; ++i) {
+        jobs[i].entry = branch_main;
+        jobs[i].param = &root->branches[i];
+    }
+
+    job_counter first_half = {};
+    job_counter second_half = {};
+    job_submit(jobs, BRANCH_JOBS / 2, &first_half);
+    job_submit_after(&first_half, jobs + BRANCH_JOBS / 2, BRANCH_JOBS / 2, &second_half);
+    job_wait(&second_half);
+    job_wait(&first_half);
+    if(__atomic_load_n(&root->branches_done, __ATOMIC_ACQUIRE) != BRANCH_JOBS) {
+        __atomic_fetch_add(&results.early_returns, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Returns the number of leaves that did not run exactly once.
+static u64 run_pass(u32 worker_count, u32 fiber_count, u32 rounds) {
+    job_system_config config = {};
+    config.worker_count = worker_count;
+    config.fiber_count = fiber_count;
+    config.fiber_stack_size = JOB_SYSTEM_FIBER_STACK_SIZE;
+    if(!job_system_initialize(config)) {
+        fprintf(stderr, "Job system failed to start with %u workers and %u fibers.\n", worker_count, fiber_count);
+        exit(1);
+    }
+
+    u64 leaf_count = (u64)rounds * LEAVES_PER_ROUND;
+    for(u64 i = 0; i < leaf_count; ++i) {
+        results.leaf_runs[i] = 0;
+    }
+
+    for(u32 r = 0; r < rounds; ++r) {
+        root_job roots[ROOT_JOBS] = {};
+        job_decl jobs[ROOT_JOBS];
+        for(u32 i = 0; i < ROOT_JOBS; ++i) {
+            for(u32 b = 0; b < BRANCH_JOBS; ++b) {
+                branch_job* branch = &roots[i].branches[b];
+                branch->root = &roots[i];
+                branch->first_leaf = (((u64)r * ROOT_JOBS + i) * BRANCH_JOBS + b) * LEAF_JOBS;
+                branch->second_half = b >= BRANCH_JOBS / 2;
+            }
+            jobs[i].entry = root_main;
+            jobs[i].param = &roots[i];
+        }
+
+        // Waits from the main thread run jobs here instead of parking.
+        job_counter counter = {};
+        job_submit(jobs, ROOT_JOBS, &counter);
+        job_wait(&counter);
+        for(u32 i = 0; i < ROOT_JOBS; ++i) {
+            if(__atomic_load_n(&roots[i].branches_done, __ATOMIC_ACQUIRE) != BRANCH_JOBS) {
+                __atomic_fetch_add(&results.early_returns, 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    job_system_shutdown();
+
+    u64 wrong = 0;
+    for(u64 i = 0; i < leaf_count; ++i) {
+        if(results.leaf_runs[i] != 1) {
+            ++wrong;
+        }
+    }
+    return wrong;
+}
+
+int main(int argc, char** argv) {
+    u32 worker_count = argc > 1 ? (u32)strtoul(argv[1], 0, 10) : 3;
+    u32 rounds = argc > 2 ? (u32)strtoul(argv[2], 0, 10) : 200;
+    if(worker_count == 0 || rounds == 0) {
+        fprintf(stderr, "Usage: %s [workers] [rounds] [fiber count]\n", argv[0]);
+        return 1;
+    }
+
+    memory_system_config memory_config = {};
+    memory_config.total_alloc_size = MEMORY_HEAP_SIZE;
+    memory_config.fit = DYNAMIC_ALLOCATOR_FIT_FIRST;
+    memory_config.frame_arena_size = MEMORY_FRAME_ARENA_SIZE;
+    if(!initialize_memory(memory_config)) {
+        return 1;
+    }
+
+    results.leaf_runs = calloc((u64)rounds * LEAVES_PER_ROUND, sizeof(u32));
+    if(!results.leaf_runs) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    u32 pass_count = FIBER_COUNT_COUNT;
+    const u32* passes = fiber_counts;
+    u32 requested_fibers = 0;
+    if(argc > 3) {
+        requested_fibers = (u32)strtoul(argv[3], 0, 10);
+        pass_count = 1;
+        passes = &requested_fibers;
+    }
+
+    printf("%u workers, %u rounds of %u leaf jobs\n", worker_count, rounds, LEAVES_PER_ROUND);
+    b8 failed = FALSE;
+    for(u32 p = 0; p < pass_count; ++p) {
+        results.early_returns = 0;
+        results.early_starts = 0;
+        f64 start = platform_get_absolute_time();
+        u64 wrong = run_pass(worker_count, passes[p], rounds);
+        f64 elapsed = platform_get_absolute_time() - start;
+
+        printf("%4u fibers: %.3fs", passes[p], elapsed);
+        if(wrong || results.early_returns || results.early_starts) {
+            printf(", FAILED: %llu leaves not run exactly once, %llu early waits, %llu early starts\n", wrong,
+                   results.early_returns, results.early_starts);
+            failed = TRUE;
+        } else {
+            printf(", ok\n");
+        }
+    }
+
+    free((void*)results.leaf_runs);
+    shutdown_memory();
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,133 @@
+// Runs producers and consumers against one mpmc_queue at the same time
+// and checks that every item came out exactly once:
+// mpmc_stress [producers] [consumers] [items per producer] [capacity]
+
+#include <defines.h>
+#include <containers/mpmc_queue.h>
+#include <core/tmemory.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_THREADS 64
+
+typedef struct stress_state {
+    mpmc_queue queue;
+    u64 items_per_producer;
+    u64 total_items;
+    // How often each item was popped; every entry must end up at 1.
+    volatile u32* counts;
+    volatile u64 consumed;
+} stress_state;
+
+typedef struct stress_thread {
+    stress_state* state;
+    u64 index;
+} stress_thread;
+
+static u32 producer_main(void* param) {
+    stress_thread* thread = param;
+    stress_state* state = thread->state;
+    u64 first = thread->index * state->items_per_producer;
+    for(u64 i = 0; i < state->items_per_producer; ++i) {
+        u64 item = first + i;
+        while(!mpmc_queue_try_push(&state->queue, &item)) {
+            platform_sleep(0);
+        }
+    }
+    return 0;
+}
+
+static u32 consumer_main(void* param) {
+    stress_thread* thread = param;
+    stress_state* state = thread->state;
+    while(__atomic_load_n(&state->consumed, __ATOMIC_RELAXED) < state->total_items) {
+        u64 item;
+        if(!mpmc_queue_try_pop(&state->queue, &item)) {
+            platform_sleep(0);
+            continue;
+        }
+        if(item >= state->total_items) {
+            fprintf(stderr, "Popped item %llu, which was never pushed.\n", item);
+            exit(2);
+        }
+        __atomic_fetch_add(&state->counts[item], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&state->consumed, 1, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    u32 producers = argc > 1 ? (u32)strtoul(argv[1], 0, 10) : 4;
+    u32 consumers = argc > 2 ? (u32)strtoul(argv[2], 0, 10) : 4;
+    u64 items_per_producer = argc > 3 ? strtoull(argv[3], 0, 10) : 1000000;
+    u64 capacity = argc > 4 ? strtoull(argv[4], 0, 10) : 1024;
+    if(producers == 0 || consumers == 0 || producers + consumers > MAX_THREADS || items_per_producer == 0 || capacity == 0) {
+        fprintf(stderr, "Usage: %s [producers] [consumers] [items per producer] [capacity]\n", argv[0]);
+        return 1;
+    }
+
+    memory_system_config memory_config = {};
+    memory_config.total_alloc_size = MEMORY_HEAP_SIZE;
+    memory_config.fit = DYNAMIC_ALLOCATOR_FIT_FIRST;
+    memory_config.frame_arena_size = MEMORY_FRAME_ARENA_SIZE;
+    if(!initialize_memory(memory_config)) {
+        return 1;
+    }
+
+    stress_state state = {};
+    state.items_per_producer = items_per_producer;
+    state.total_items = producers * items_per_producer;
+    state.counts = calloc(state.total_items, sizeof(u32));
+    if(!state.counts || !mpmc_queue_create(sizeof(u64), capacity, &state.queue)) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    printf("%u producers, %u consumers, %llu items, capacity %llu\n", producers, consumers, state.total_items,
+           mpmc_queue_capacity(&state.queue));
+
+    stress_thread params[MAX_THREADS];
+    platform_thread threads[MAX_THREADS];
+    u32 thread_count = producers + consumers;
+    f64 start = platform_get_absolute_time();
+    for(u32 i = 0; i < thread_count; ++i) {
+        params[i].state = &state;
+        params[i].index = i < consumers ? i : i - consumers;
+        if(!platform_thread_create(i < consumers ? consumer_main : producer_main, &params[i], &threads[i])) {
+            return 1;
+        }
+    }
+    for(u32 i = 0; i < thread_count; ++i) {
+        platform_thread_join(&threads[i]);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    u64 missing = 0;
+    u64 duplicated = 0;
+    for(u64 i = 0; i < state.total_items; ++i) {
+        if(state.counts[i] == 0) {
+            ++missing;
+        } else if(state.counts[i] > 1) {
+            ++duplicated;
+        }
+    }
+    u64 leftover = 0;
+    u64 item;
+    while(mpmc_queue_try_pop(&state.queue, &item)) {
+        ++leftover;
+    }
+
+    mpmc_queue_destroy(&state.queue);
+    free((void*)state.counts);
+    shutdown_memory();
+
+    printf("%.3fs, %.2f M items/s\n", elapsed, state.total_items / elapsed / 1000000.0);
+    if(missing || duplicated || leftover) {
+        printf("FAILED: %llu missing, %llu delivered more than once, %llu left in the queue\n", missing, duplicated, leftover);
+        return 2;
+    }
+    printf("Every item was delivered exactly once.\n");
+    return 0;
+}
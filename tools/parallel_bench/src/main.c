@@ -0,0 +1,171 @@
+// Times parallel_for and parallel_reduce over a darray of transforms with
+// 1..N threads and a few grain sizes, to see how they scale and whether
+// the automatic grain size holds up:
+// parallel_bench [transforms] [max threads] [runs]
+
+#include <defines.h>
+#include <containers/darray.h>
+#include <core/job_system.h>
+#include <core/parallel.h>
+#include <core/tmemory.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Sized like a game object's transform, so the loops stride through memory
+// the way per-object updates do.
+typedef struct bench_transform {
+    f32 position[3];
+    f32 rotation[4];
+    f32 scale[3];
+    // Written by update_range and summed by sum_range.
+    f32 value;
+} bench_transform;
+
+// 0 is the automatic grain size.
+static const u64 grain_sizes[] = {0, 256, 4096, 65536};
+#define GRAIN_SIZE_COUNT (sizeof(grain_sizes) / sizeof(grain_sizes[0]))
+
+static void update_range(u64 begin, u64 end, void* user_data) {
+    bench_transform* transforms = user_data;
+    for(u64 i = begin; i < end; ++i) {
+        bench_transform* t = &transforms[i];
+        f32 x = t->rotation[0], y = t->rotation[1], z = t->rotation[2], w = t->rotation[3];
+        // Moves along the rotated x axis, scaled.
+        t->position[0] += (1.0f - 2.0f * (y * y + z * z)) * t->scale[0] * 0.01f;
+        t->position[1] += 2.0f * (x * y + w * z) * t->scale[1] * 0.01f;
+        t->position[2] += 2.0f * (x * z - w * y) * t->scale[2] * 0.01f;
+        t->value = t->position[0] + t->position[1] + t->position[2];
+    }
+}
+
+static void sum_range(u64 begin, u64 end, void* result, void* user_data) {
+    const bench_transform* transforms = user_data;
+    f64 sum = *(f64*)result;
+    for(u64 i = begin; i < end; ++i) {
+        sum += transforms[i].value;
+    }
+    *(f64*)result = sum;
+}
+
+static void sum_combine(void* accumulator, const void* value, void* user_data) {
+    *(f64*)accumulator += *(const f64*)value;
+}
+
+static void reset_values(bench_transform* transforms, u64 count) {
+    for(u64 i = 0; i < count; ++i) {
+        bench_transform* t = &transforms[i];
+        f32 f = (f32)(i & 1023) / 1024.0f;
+        t->position[0] = f;
+        t->position[1] = -f;
+        t->position[2] = f * 0.5f;
+        // A rotation about z, normalised closely enough for a benchmark.
+        t->rotation[0] = 0.0f;
+        t->rotation[1] = 0.0f;
+        t->rotation[2] = f * 0.5f;
+        t->rotation[3] = 1.0f - f * 0.125f;
+        t->scale[0] = t->scale[1] = t->scale[2] = 1.0f + f;
+        t->value = 0.0f;
+    }
+}
+
+// Best time in ms over runs.
+static f64 time_for(bench_transform* values, u64 count, u64 grain_size, u32 runs) {
+    f64 best = -1.0;
+    for(u32 r = 0; r < runs; ++r) {
+        reset_values(values, count);
+        f64 start = platform_get_absolute_time();
+        parallel_for(count, grain_size, update_range, values);
+        f64 elapsed = (platform_get_absolute_time() - start) * 1000.0;
+        if(best < 0.0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static f64 time_reduce(bench_transform* values, u64 count, u64 grain_size, u32 runs, f64* out_sum) {
+    f64 best = -1.0;
+    f64 identity = 0.0;
+    for(u32 r = 0; r < runs; ++r) {
+        f64 start = platform_get_absolute_time();
+        parallel_reduce(count, grain_size, sizeof(f64), &identity, sum_range, sum_combine, values, out_sum);
+        f64 elapsed = (platform_get_absolute_time() - start) * 1000.0;
+        if(best < 0.0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    u64 count = argc > 1 ? strtoull(argv[1], 0, 10) : 1024 * 1024;
+    u32 max_threads = argc > 2 ? (u32)strtoul(argv[2], 0, 10) : platform_get_processor_count();
+    u32 runs = argc > 3 ? (u32)strtoul(argv[3], 0, 10) : 5;
+    if(count == 0 || max_threads == 0 || runs == 0) {
+        fprintf(stderr, "Usage: %s [transforms] [max threads] [runs]\n", argv[0]);
+        return 1;
+    }
+
+    memory_system_config memory_config = {};
+    memory_config.total_alloc_size = MEMORY_HEAP_SIZE;
+    memory_config.fit = DYNAMIC_ALLOCATOR_FIT_FIRST;
+    memory_config.frame_arena_size = MEMORY_FRAME_ARENA_SIZE;
+    if(!initialize_memory(memory_config)) {
+        return 1;
+    }
+
+    bench_transform* values = darray_reserve(bench_transform, count);
+    darray_length_set(values, count);
+
+    printf("%llu transforms, best of %u runs, times in ms (speedup over 1 thread)\n", count, runs);
+    printf("threads      grain     parallel_for           parallel_reduce\n");
+
+    f64 serial_for[GRAIN_SIZE_COUNT];
+    f64 serial_reduce[GRAIN_SIZE_COUNT];
+    f64 expected_sum = 0.0;
+    for(u32 threads = 1; threads <= max_threads; ++threads) {
+        // One thread runs without the job system, which is the serial path.
+        if(threads > 1) {
+            job_system_config job_config = {};
+            job_config.worker_count = threads - 1;
+            job_config.fiber_count = JOB_SYSTEM_FIBER_COUNT;
+            job_config.fiber_stack_size = JOB_SYSTEM_FIBER_STACK_SIZE;
+            if(!job_system_initialize(job_config)) {
+                return 1;
+            }
+        }
+
+        for(u32 g = 0; g < GRAIN_SIZE_COUNT; ++g) {
+            f64 for_ms = time_for(values, count, grain_sizes[g], runs);
+            f64 sum = 0.0;
+            f64 reduce_ms = time_reduce(values, count, grain_sizes[g], runs, &sum);
+            if(threads == 1) {
+                serial_for[g] = for_ms;
+                serial_reduce[g] = reduce_ms;
+                expected_sum = sum;
+            } else if(sum < expected_sum * 0.999999 || sum > expected_sum * 1.000001) {
+                fprintf(stderr, "parallel_reduce returned %f, expected %f.\n", sum, expected_sum);
+                return 2;
+            }
+
+            char grain[16];
+            if(grain_sizes[g] == 0) {
+                snprintf(grain, sizeof(grain), "auto");
+            } else {
+                snprintf(grain, sizeof(grain), "%llu", grain_sizes[g]);
+            }
+            printf("%7u %10s %10.3f (%5.2fx) %10.3f (%5.2fx)\n", threads, grain, for_ms, serial_for[g] / for_ms,
+                   reduce_ms, serial_reduce[g] / reduce_ms);
+        }
+
+        if(threads > 1) {
+            job_system_shutdown();
+        }
+    }
+
+    darray_destroy(values);
+    shutdown_memory();
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Moves items from one producer thread to one consumer thread and reports
+// the throughput of spsc_queue next to a ring_queue guarded by a
+// platform_mutex: spsc_bench [items] [capacity] [runs]
+
+#include <defines.h>
+#include <containers/ring_queue.h>
+#include <core/tmemory.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct bench_queue {
+    b8 use_mutex;
+    spsc_queue spsc;
+    ring_queue ring;
+    platform_mutex mutex;
+    u64 items;
+    u64 consumed_sum;
+} bench_queue;
+
+static b8 bench_push(bench_queue* queue, u64 value) {
+    if(!queue->use_mutex) {
+        return spsc_queue_try_push(&queue->spsc, &value);
+    }
+
+    platform_mutex_lock(&queue->mutex);
+    b8 pushed = ring_queue_enqueue(&queue->ring, &value);
+    platform_mutex_unlock(&queue->mutex);
+    return pushed;
+}
+
+static b8 bench_pop(bench_queue* queue, u64* out_value) {
+    if(!queue->use_mutex) {
+        return spsc_queue_try_pop(&queue->spsc, out_value);
+    }
+
+    platform_mutex_lock(&queue->mutex);
+    b8 popped = ring_queue_dequeue(&queue->ring, out_value);
+    platform_mutex_unlock(&queue->mutex);
+    return popped;
+}
+
+static u32 consumer_main(void* param) {
+    bench_queue* queue = param;
+    u64 sum = 0;
+    for(u64 received = 0; received < queue->items;) {
+        u64 value;
+        if(bench_pop(queue, &value)) {
+            sum += value;
+            ++received;
+        } else {
+            // Yielding keeps the test meaningful when there are fewer cores
+            // than threads.
+            platform_sleep(0);
+        }
+    }
+    queue->consumed_sum = sum;
+    return 0;
+}
+
+// Returns items per second, or 0 if anything went wrong.
+static f64 run(b8 use_mutex, u64 items, u64 capacity) {
+    bench_queue queue = {};
+    queue.use_mutex = use_mutex;
+    queue.items = items;
+    if(use_mutex) {
+        if(!ring_queue_create(sizeof(u64), capacity, 0, &queue.ring) || !platform_mutex_create(&queue.mutex)) {
+            return 0;
+        }
+    } else if(!spsc_queue_create(sizeof(u64), capacity, 0, &queue.spsc)) {
+        return 0;
+    }
+
+    platform_thread consumer;
+    f64 start = platform_get_absolute_time();
+    if(!platform_thread_create(consumer_main, &queue, &consumer)) {
+        return 0;
+    }
+    for(u64 i = 0; i < items; ++i) {
+        while(!bench_push(&queue, i)) {
+            platform_sleep(0);
+        }
+    }
+    platform_thread_join(&consumer);
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    if(use_mutex) {
+        platform_mutex_destroy(&queue.mutex);
+        ring_queue_destroy(&queue.ring);
+    } else {
+        spsc_queue_destroy(&queue.spsc);
+    }
+
+    if(queue.consumed_sum != items * (items - 1) / 2) {
+        fprintf(stderr, "Consumer saw the wrong items (sum %llu).\n", queue.consumed_sum);
+        return 0;
+    }
+    return items / elapsed;
+}
+
+int main(int argc, char** argv) {
+    u64 items = argc > 1 ? strtoull(argv[1], 0, 10) : 10000000;
+    u64 capacity = argc > 2 ? strtoull(argv[2], 0, 10) : 1024;
+    u32 runs = argc > 3 ? (u32)strtoul(argv[3], 0, 10) : 5;
+    if(items == 0 || capacity == 0 || runs == 0) {
+        fprintf(stderr, "Usage: %s [items] [capacity] [runs]\n", argv[0]);
+        return 1;
+    }
+
+    memory_system_config memory_config = {};
+    memory_config.total_alloc_size = MEMORY_HEAP_SIZE;
+    memory_config.fit = DYNAMIC_ALLOCATOR_FIT_FIRST;
+    memory_config.frame_arena_size = MEMORY_FRAME_ARENA_SIZE;
+    if(!initialize_memory(memory_config)) {
+        return 1;
+    }
+
+    printf("%llu items, capacity %llu, best of %u runs\n", items, capacity, runs);
+    const char* names[2] = {"spsc_queue", "mutex + ring_queue"};
+    f64 best[2] = {0, 0};
+    for(u32 r = 0; r < runs; ++r) {
+        for(u32 i = 0; i < 2; ++i) {
+            f64 rate = run(i == 1, items, capacity);
+            if(rate == 0) {
+                return 2;
+            }
+            if(rate > best[i]) {
+                best[i] = rate;
+            }
+        }
+    }
+
+    for(u32 i = 0; i < 2; ++i) {
+        printf("%-20s %10.2f M items/s\n", names[i], best[i] / 1000000.0);
+    }
+    printf("spsc_queue speedup   %10.2fx\n", best[0] / best[1]);
+
+    shutdown_memory();
+    return 0;
+}
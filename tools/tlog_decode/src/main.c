@@ -0,0 +1,134 @@
+// Turns a binary log written by the engine's deferred logger back into
+// text: tlog_decode <file.tlog>
+
+#include <defines.h>
+#include <core/log_binary.inl>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_FORMATS 65536
+
+typedef struct decoded_format {
+    char* format;
+    char* file;
+    u32 line;
+    u8 level;
+    u8 arg_types[LOG_BINARY_MAX_ARGS];
+} decoded_format;
+
+static const char* level_strings[6] = {
+    "[FATAL]: ",
+    "[ERROR]: ",
+    "[WARN]:  ",
+    "[INFO]:  ",
+    "[DEBUG]: ",
+    "[TRACE]: ",
+};
+
+static decoded_format formats[MAX_FORMATS];
+
+static b8 read_exact(FILE* file, void* out, u64 size) {
+    return fread(out, 1, size, file) == size;
+}
+
+static char* read_string(FILE* file, u16 length) {
+    char* text = malloc(length + 1);
+    if(!read_exact(file, text, length)) {
+        free(text);
+        return 0;
+    }
+    text[length] = 0;
+    return text;
+}
+
+static b8 read_format(FILE* file) {
+    u32 id;
+    u8 level;
+    u32 line;
+    u16 format_length;
+    u16 file_length;
+    if(!read_exact(file, &id, sizeof(id)) || !read_exact(file, &level, sizeof(level)) ||
+       !read_exact(file, &line, sizeof(line)) || !read_exact(file, &format_length, sizeof(format_length)) ||
+       !read_exact(file, &file_length, sizeof(file_length))) {
+        return FALSE;
+    }
+    if(id == 0 || id >= MAX_FORMATS || level > 5) {
+        fprintf(stderr, "Invalid format id %u.\n", id);
+        return FALSE;
+    }
+
+    decoded_format* format = &formats[id];
+    format->format = read_string(file, format_length);
+    format->file = read_string(file, file_length);
+    format->line = line;
+    format->level = level;
+    if(!format->format || !format->file) {
+        return FALSE;
+    }
+    return log_binary_parse_format(format->format, format->arg_types) >= 0;
+}
+
+static b8 read_record(FILE* file) {
+    log_binary_record record;
+    if(!read_exact(file, &record, sizeof(record))) {
+        return FALSE;
+    }
+    if(record.format_id == 0 || record.format_id >= MAX_FORMATS || !formats[record.format_id].format) {
+        fprintf(stderr, "Record refers to unknown format id %u.\n", record.format_id);
+        return FALSE;
+    }
+
+    decoded_format* format = &formats[record.format_id];
+    char text[4096];
+    log_binary_format_record(format->format, format->arg_types, &record, text, sizeof(text));
+    printf("%12.6f %s%s (%s:%u)\n", record.time, level_strings[format->level], text, format->file, format->line);
+    return TRUE;
+}
+
+int main(int argc, char** argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s <file.tlog>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "rb");
+    if(!file) {
+        fprintf(stderr, "Could not open %s.\n", argv[1]);
+        return 1;
+    }
+
+    u32 header[2];
+    if(!read_exact(file, header, sizeof(header)) || header[0] != LOG_BINARY_FILE_MAGIC) {
+        fprintf(stderr, "%s is not a binary log.\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+    if(header[1] != LOG_BINARY_FILE_VERSION) {
+        fprintf(stderr, "Unsupported binary log version %u.\n", header[1]);
+        fclose(file);
+        return 1;
+    }
+
+    int result = 0;
+    u8 kind;
+    while(read_exact(file, &kind, sizeof(kind))) {
+        b8 ok = FALSE;
+        if(kind == LOG_BINARY_CHUNK_FORMAT) {
+            ok = read_format(file);
+        } else if(kind == LOG_BINARY_CHUNK_RECORD) {
+            ok = read_record(file);
+        } else {
+            fprintf(stderr, "Unknown chunk kind %u.\n", kind);
+        }
+
+        if(!ok) {
+            fprintf(stderr, "Stopped at a truncated or corrupt chunk.\n");
+            result = 2;
+            break;
+        }
+    }
+
+    fclose(file);
+    return result;
+}